@@ -8,45 +8,23 @@
  */
  
 #include "DYPTH01.h"
+#include "Crc8.h"
 #include "HWlib.h"
+#include "semphr.h"
 
-#define FIRST_POLL_DELAY 3 // 30ms
-#define OTHER_POLL_DELAY 5 // 50ms
-#define POLL_RETRY_COUNT 8
+#define READ_TIMEOUT (430 / portTICK_RATE_MS) // the longest wait of the former polling loop
 #define DATA_SIZE 4
 
 static unsigned char _data_buf[DATA_SIZE];
 static volatile unsigned char _data_cnt = 0;
 static int _pin_ss_n = -1;
-
-static const unsigned char CRC8_TABLE[] = {
-    0, 49, 98, 83, 196, 245, 166, 151, 185, 136, 219, 234, 125, 76, 31, 46, 67, 114, 33, 16, 135, 182, 229, 212, 250,
-    203, 152, 169, 62, 15, 92, 109, 134, 183, 228, 213, 66, 115, 32, 17, 63, 14, 93, 108, 251, 202, 153, 168, 197,
-    244, 167, 150, 1, 48, 99, 82, 124, 77, 30, 47, 184, 137, 218, 235, 61, 12, 95, 110, 249, 200, 155, 170, 132, 181,
-    230, 215, 64, 113, 34, 19, 126, 79, 28, 45, 186, 139, 216, 233, 199, 246, 165, 148, 3, 50, 97, 80, 187, 138, 217,
-    232, 127, 78, 29, 44, 2, 51, 96, 81, 198, 247, 164, 149, 248, 201, 154, 171, 60, 13, 94, 111, 65, 112, 35, 18,
-    133, 180, 231, 214, 122, 75, 24, 41, 190, 143, 220, 237, 195, 242, 161, 144, 7, 54, 101, 84, 57, 8, 91, 106,
-    253, 204, 159, 174, 128, 177, 226, 211, 68, 117, 38, 23, 252, 205, 158, 175, 56, 9, 90, 107, 69, 116, 39, 22,
-    129, 176, 227, 210, 191, 142, 221, 236, 123, 74, 25, 40, 6, 55, 100, 85, 194, 243, 160, 145, 71, 118, 37, 20,
-    131, 178, 225, 208, 254, 207, 156, 173, 58, 11, 88, 105, 4, 53, 102, 87, 192, 241, 162, 147, 189, 140, 223,
-    238, 121, 72, 27, 42, 193, 240, 163, 146, 5, 52, 103, 86, 120, 73, 26, 43, 188, 141, 222, 239, 130, 179, 224,
-    209, 70, 119, 36, 21, 59, 10, 89, 104, 255, 206, 157, 172
-};
-
-static unsigned char _calc_crc8(const unsigned char *x, int len)
-{
-    int i;
-    unsigned char crc = 0;
-    
-    for (i = 0; i < len; ++i) {
-        crc = crc ^ x[i];
-    }
-    return crc;
-}
+static xSemaphoreHandle _data_ready = NULL; // given by the ISR when the frame is complete
+static unsigned int _crc_errors = 0;
 
 void __attribute__((__interrupt__, no_auto_psv)) _SPI2Interrupt(void)
 {
     unsigned char cnt = _data_cnt;
+    signed portBASE_TYPE woken = pdFALSE;
     IFS2bits.SPI2IF = 0;
     if (cnt < DATA_SIZE) {
         _data_buf[cnt] = SPI2BUF;
@@ -57,6 +35,10 @@ void __attribute__((__interrupt__, no_auto_psv)) _SPI2Interrupt(void)
     if (DATA_SIZE == cnt) {
         IOPut(_pin_ss_n, ON);
         IEC2bits.SPI2IE = 0; // Disable the interrupt
+        xSemaphoreGiveFromISR(_data_ready, &woken);
+        if (woken != pdFALSE) {
+            taskYIELD();
+        }
     }
 }
 
@@ -69,9 +51,15 @@ void TH01_InitPort(int pin_sdi, int pin_sdo, int pin_sck, int pin_ss_n)
 	IOInit(pin_ss_n, OUT);
     _pin_ss_n = pin_ss_n;
 
+    if (NULL == _data_ready) {
+        vSemaphoreCreateBinary(_data_ready);
+        xSemaphoreTake(_data_ready, 0); // created given, no frame yet
+    }
+
     SPI2BUF = 0;
     IFS2bits.SPI2IF = 0; // Clear the Interrupt flag
     IEC2bits.SPI2IE = 0; // Disable the interrupt
+    IPC8bits.SPI2IP = configKERNEL_INTERRUPT_PRIORITY; // the ISR uses the FreeRTOS FromISR API
     // SPI2CON1 Register Settings
     SPI2CON1bits.DISSCK = 0; // Internal Serial Clock is enabled
     SPI2CON1bits.DISSDO = 0; // SDOx pin is controlled by the module
@@ -89,30 +77,31 @@ void TH01_InitPort(int pin_sdi, int pin_sdo, int pin_sck, int pin_ss_n)
     //IEC2bits.SPI2IE = 1; // Enable the interrupt
 }
 
-int TH01_ReadData(int *t, int *hr)
+void TH01_StartRead(void)
 {
-    int i = 0;
     // it takes about 20ms for transmission when SS_NEG is set low and sample is ready
     // it takes 200ms for acquiring the sample
-    //unsigned char buf[4];
+    IEC2bits.SPI2IE = 0; // Disable the interrupt
+    xSemaphoreTake(_data_ready, 0); // drop a completion left by an aborted read
+    _data_cnt = 0;
     IFS2bits.SPI2IF = 0; // Clear the Interrupt flag
     IEC2bits.SPI2IE = 1; // Enable the interrupt
-   
-    _data_cnt = 0;
     IOPut(_pin_ss_n, OFF);
-    vTaskDelay(FIRST_POLL_DELAY); // wait for sample to get ready
-    while (DATA_SIZE != _data_cnt && i < POLL_RETRY_COUNT) {
-        vTaskDelay(OTHER_POLL_DELAY);
-        ++i;
-    }
+}
 
-    if (DATA_SIZE != _data_cnt) {
-        IOPut(_pin_ss_n, ON);
+int TH01_WaitData(int *t, int *hr, unsigned int timeout)
+{
+    if (pdTRUE != xSemaphoreTake(_data_ready, (portTickType)timeout)) {
+        if (0 == timeout) {
+            return 3;
+        }
         IEC2bits.SPI2IE = 0; // Disable the interrupt
+        IOPut(_pin_ss_n, ON);
         return 1;
     }
     
-    if (0 != _calc_crc8(_data_buf, DATA_SIZE)) {
+    if (0 != CRC8_Calc(_data_buf, DATA_SIZE)) {
+        ++_crc_errors;
         return 2;
     }
     
@@ -120,3 +109,14 @@ int TH01_ReadData(int *t, int *hr)
     *hr = _data_buf[2];
     return 0;
 }
+
+int TH01_ReadData(int *t, int *hr)
+{
+    TH01_StartRead();
+    return TH01_WaitData(t, hr, READ_TIMEOUT);
+}
+
+unsigned int TH01_GetCrcErrors(void)
+{
+    return _crc_errors;
+}
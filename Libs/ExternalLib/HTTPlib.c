@@ -62,80 +62,471 @@ The HTTP library contains all the commands to send an HTTP request (POST and GET
 
 static char hex[] = {'\x24','\x26','\x2B','\x2C','\x2F','\x3A','\x3B','\x3D','\x3F','\x40','\x20','\x22','\x3C','\x3E','\x23','\x25','\x7B','\x7D','\x7C','\x5C','\x5E','\x7E','\x5B','\x5D','\x60'};
 
-__eds__ char eds_space[HTTP_MAX_SIZE] __attribute__((eds));
-
 /// @cond
-int HTTP_Read(TCP_SOCKET socket, char * header, int headersize, char * body, int bodysize, int timeout)
+#define HTTP_ST_HEADER 0		// status line and headers
+#define HTTP_ST_LENGTH 1		// body delimited by Content-Length
+#define HTTP_ST_CLOSE 2			// body delimited by the connection close
+#define HTTP_ST_CHUNK_SIZE 3	// chunked body: size line of a chunk
+#define HTTP_ST_CHUNK_DATA 4	// chunked body: data of a chunk
+#define HTTP_ST_CHUNK_END 5		// chunked body: CRLF after the data
+#define HTTP_ST_TRAILER 6		// chunked body: trailer headers
+#define HTTP_ST_DONE 7
+#define HTTP_ST_ERROR 8			// malformed response, e.g. a chunk size too large
+
+typedef struct
 {
-	int cnt = 0, len = 0, len1=0, len2=0, crlf = 0, i, j;
-	char code[4], bff[505];
-	
-	while( (TCPRxLen(socket) < 15) && (cnt < timeout/10) )
+	BYTE state;
+	BYTE field;
+	BYTE chunked;
+	BYTE haslength;
+	BYTE ext;
+	BYTE linelen;
+	int code;
+	DWORD remaining;
+	char line[HTTP_LINE_SIZE];
+} HTTP_PARSER;
+
+typedef struct
+{
+	char * header;
+	int headersize;
+	int headerlen;
+	char * body;
+	int bodysize;
+	int bodylen;
+} HTTP_BUFFERS;
+
+//	Case insensitive check of a header name at the start of line
+static BOOL _HTTP_IsHeader(char * line, char * name)
+{
+	while(*name != '\0')
 	{
-		vTaskDelay(1);
-		cnt++; 
+		if((*line | 0x20) != (*name | 0x20))
+			return FALSE;
+		line++;
+		name++;
 	}
+	return TRUE;
+}
 
-	if(cnt == timeout/10)
-		return READ_TIMEOUT;
-	
-	while((len=TCPRxLen(socket))>0)
+//	Looks for the headers which delimit the body in a complete header line
+static void _HTTP_HeaderLine(HTTP_PARSER * p)
+{
+	char * v;
+
+	p->line[p->linelen] = '\0';
+	if(_HTTP_IsHeader(p->line, "Content-Length:"))
 	{
-		if(len>500)
-			len=500;
-		TCPRead(socket, bff, len);
-		len1=len1+len;
-		if(len1>=HTTP_MAX_SIZE)
-			len1=HTTP_MAX_SIZE-1;
-		for(cnt=len2;cnt<len1;cnt++)
-			eds_space[cnt]=bff[cnt-len2];
-		len2=len1;
-		if(len1==HTTP_MAX_SIZE-1)
-			break;
-		#ifdef DBG_HTTP_READ
-			_dbgwrite(bff);
-		#endif
+		p->haslength = 1;
+		p->remaining = 0;
+		for(v = p->line + 15; *v == ' '; v++);
+		for(; (*v >= '0') && (*v <= '9'); v++)
+			p->remaining = p->remaining*10 + (*v - '0');
+	}
+	else if(_HTTP_IsHeader(p->line, "Transfer-Encoding:"))
+	{
+		for(v = p->line + 18; *v != '\0'; v++)
+		{
+			if(_HTTP_IsHeader(v, "chunked"))
+				p->chunked = 1;
+		}
 	}
+}
 
-	eds_space[len2]='\0';
-	
-	for(j=9; j<12; j++)
-		code[j-9] = eds_space[j];
-	code[3] = '\0';
-	
-	for(i=0;i<len2;i++)
+//	Chooses how the body is delimited once the headers are over
+static void _HTTP_HeaderEnd(HTTP_PARSER * p)
+{
+	if((p->code >= 100) && (p->code < 200))
 	{
-		if(crlf==4)
-			break;
-		if( (eds_space[i] == '\r') || (eds_space[i] == '\n'))
-			crlf++;
-		else
-			crlf=0;
+		//	interim response, the real one follows
+		p->field = 0;
+		p->code = 0;
+		p->chunked = 0;
+		p->haslength = 0;
 	}
-	for(j=0;j<i;j++)
+	else if((p->code == 204) || (p->code == 304))
+		p->state = HTTP_ST_DONE;
+	else if(p->chunked)
 	{
-		if(j==headersize)
-			break;
-		header[j]=eds_space[j];
+		p->state = HTTP_ST_CHUNK_SIZE;
+		p->remaining = 0;
+		p->ext = 0;
 	}
-	header[j]='\0';
+	else if(p->haslength)
+		p->state = (p->remaining > 0) ? HTTP_ST_LENGTH : HTTP_ST_DONE;
+	else
+		p->state = HTTP_ST_CLOSE;
+}
 
-	if(crlf==4)
+static BYTE _HTTP_HexValue(char c)
+{
+	if((c >= '0') && (c <= '9'))
+		return c - '0';
+	c |= 0x20;
+	if((c >= 'a') && (c <= 'f'))
+		return c - 'a' + 10;
+	return 0xFF;
+}
+
+//	Feeds a piece of the response to the parser: status line, headers and
+//	chunk framing are scanned in place, headers and body data are handed to
+//	the sink, nothing is copied
+static void _HTTP_Parse(HTTP_PARSER * p, char * data, int len, HTTP_SINK sink, void * ctx)
+{
+	int i = 0, start;
+	DWORD n;
+	BYTE v;
+	char c;
+
+	while((i < len) && (p->state != HTTP_ST_DONE) && (p->state != HTTP_ST_ERROR))
 	{
-		for(j=i;j<len2;j++)
+		switch(p->state)
 		{
-			if(j-i==bodysize)
+			case HTTP_ST_HEADER:
+				start = i;
+				for(; (i < len) && (p->state == HTTP_ST_HEADER); i++)
+				{
+					c = data[i];
+					//	status line, e.g. "HTTP/1.1 200 OK": the code is the second field
+					if(p->field < 2)
+					{
+						if(c == ' ')
+							p->field++;
+						else if(c == '\n')
+							p->field = 2;
+						else if((p->field == 1) && (c >= '0') && (c <= '9'))
+							p->code = p->code*10 + (c - '0');
+					}
+					if(c == '\n')
+					{
+						if(p->linelen == 0)
+							_HTTP_HeaderEnd(p);
+						else
+							_HTTP_HeaderLine(p);
+						p->linelen = 0;
+					}
+					else if((c != '\r') && (p->linelen < HTTP_LINE_SIZE-1))
+						p->line[p->linelen++] = c;
+				}
+				if(sink != NULL)
+					sink(ctx, HTTP_SINK_HEADER, data+start, i-start);
+				break;
+
+			case HTTP_ST_LENGTH:
+			case HTTP_ST_CHUNK_DATA:
+			case HTTP_ST_CLOSE:
+				n = len - i;
+				if((p->state != HTTP_ST_CLOSE) && (n > p->remaining))
+					n = p->remaining;
+				if(sink != NULL)
+					sink(ctx, HTTP_SINK_BODY, data+i, (int) n);
+				i += (int) n;
+				if(p->state != HTTP_ST_CLOSE)
+				{
+					p->remaining -= n;
+					if(p->remaining == 0)
+						p->state = (p->state == HTTP_ST_LENGTH) ? HTTP_ST_DONE : HTTP_ST_CHUNK_END;
+				}
+				break;
+
+			case HTTP_ST_CHUNK_SIZE:
+				c = data[i++];
+				if(c == '\n')
+				{
+					p->linelen = 0;
+					p->state = (p->remaining > 0) ? HTTP_ST_CHUNK_DATA : HTTP_ST_TRAILER;
+				}
+				else if(c == ';')
+					p->ext = 1;
+				else if(!p->ext && ((v = _HTTP_HexValue(c)) != 0xFF))
+				{
+					//	one more digit would shift the size out of the DWORD
+					if(p->remaining > 0x0FFFFFFFul)
+						p->state = HTTP_ST_ERROR;
+					else
+						p->remaining = (p->remaining << 4) | v;
+				}
+				break;
+
+			case HTTP_ST_CHUNK_END:
+				if(data[i++] == '\n')
+				{
+					p->state = HTTP_ST_CHUNK_SIZE;
+					p->remaining = 0;
+					p->ext = 0;
+				}
+				break;
+
+			case HTTP_ST_TRAILER:
+				c = data[i++];
+				if(c == '\n')
+				{
+					if(p->linelen == 0)
+						p->state = HTTP_ST_DONE;
+					p->linelen = 0;
+				}
+				else if(c != '\r')
+					p->linelen = 1;
 				break;
-			body[j-i]=eds_space[j];
 		}
 	}
-	body[j-i]='\0';
+}
 
-	return atoi(code);
-			
+//	Number of bytes the parser can take without reading past the response
+static int _HTTP_Want(HTTP_PARSER * p)
+{
+	if(((p->state == HTTP_ST_LENGTH) || (p->state == HTTP_ST_CHUNK_DATA)) && (p->remaining < HTTP_CHUNK_SIZE))
+		return (int) p->remaining;
+	return HTTP_CHUNK_SIZE;
+}
+
+//	Sink used by HTTP_Read to fill the caller buffers
+static void _HTTP_BufferSink(void * ctx, int event, char * data, int len)
+{
+	HTTP_BUFFERS * b = (HTTP_BUFFERS *) ctx;
+	char * dest;
+	int * used;
+	int room;
+
+	if(event == HTTP_SINK_HEADER)
+	{
+		dest = b->header;
+		used = &b->headerlen;
+		room = b->headersize - 1 - b->headerlen;
+	}
+	else
+	{
+		dest = b->body;
+		used = &b->bodylen;
+		room = b->bodysize - 1 - b->bodylen;
+	}
+	if(len > room)
+		len = room;
+	if(len > 0)
+	{
+		memcpy(dest + *used, data, len);
+		*used += len;
+	}
 }
 /// @endcond
 
+/**
+ * Function to read the response of a request, parsing it while it is read from the socket.
+ * The response is read in chunks of HTTP_CHUNK_SIZE bytes, status line and headers are passed to the sink with
+ * event HTTP_SINK_HEADER, the body with event HTTP_SINK_BODY; no other copy of the response is kept, so bodies
+ * of any size can be read. The body is delimited by Content-Length or Transfer-Encoding: chunked (chunks are
+ * passed to the sink without the framing) and exactly one response is consumed, so the socket can be reused.
+ * \param socket - the handle of the socket to use
+ * \param sink - function called for each piece of the response (NULL to discard the response)
+ * \param ctx - pointer passed unchanged to the sink
+ * \param timeout - timeout period in 10ms for the whole response
+ * \return the HTTP code or 0 for timeout, incomplete or malformed response
+ */
+int HTTP_ReadStream(TCP_SOCKET socket, HTTP_SINK sink, void * ctx, int timeout)
+{
+	int len, want;
+	WORD avail;
+	char chunk[HTTP_CHUNK_SIZE+1];
+	HTTP_PARSER parser;
+	portTickType start = xTaskGetTickCount(), ticks = HTTP_TICKS(timeout), elapsed;
+
+	memset(&parser, 0, sizeof(parser));
+	
+	//	sleeps until the TCP/IP task reports the start of the response
+	avail = TCPRxWait(socket, 15, ticks);
+	if(avail < 15)
+		return READ_TIMEOUT;
+	
+	while((parser.state != HTTP_ST_DONE) && (parser.state != HTTP_ST_ERROR))
+	{
+		if(avail == 0)
+		{
+			elapsed = xTaskGetTickCount() - start;
+			if(elapsed >= ticks)
+				break;
+			avail = TCPRxWait(socket, 1, ticks - elapsed);
+			if(avail == 0)
+			{
+				//	the server closing the connection ends a body without length
+				if((parser.state == HTTP_ST_CLOSE) && !TCPisConn(socket))
+					parser.state = HTTP_ST_DONE;
+				break;
+			}
+		}
+		len = avail;
+		want = _HTTP_Want(&parser);
+		if(len > want)
+			len = want;
+		len = TCPReadMax(socket, chunk, len);
+		if(len == 0)
+		{
+			avail = 0;
+			continue;
+		}
+		avail -= len;
+		#ifdef DBG_HTTP_READ
+			chunk[len] = '\0';
+			_dbgwrite(chunk);
+		#endif
+		_HTTP_Parse(&parser, chunk, len, sink, ctx);
+	}
+
+	if(parser.state != HTTP_ST_DONE)
+		return READ_TIMEOUT;
+	return parser.code;
+}
+
+/**
+ * Function to read only the HTTP code of the response of a request, the rest of the response is discarded.
+ * \param socket - the handle of the socket to use
+ * \param timeout - timeout period in 10ms
+ * \return the HTTP code or 0 for timeout or incomplete response
+ */
+int HTTP_ReadStatus(TCP_SOCKET socket, int timeout)
+{
+	return HTTP_ReadStream(socket, NULL, NULL, timeout);
+}
+
+/**
+ * Function to read the response of a request into the header and body buffers. The parts of the response which
+ * don't fit in the buffers are read from the socket and discarded.
+ * \param socket - the handle of the socket to use
+ * \param header - pointer in which to store the header response
+ * \param headersize - length of the header array (use ARRAY_SIZE(header))
+ * \param body - pointer in which to store the body response
+ * \param bodysize - length of the body array (use ARRAY_SIZE(body))
+ * \param timeout - timeout period in 10ms
+ * \return the HTTP code or 0 for timeout or incomplete response
+ */
+int HTTP_Read(TCP_SOCKET socket, char * header, int headersize, char * body, int bodysize, int timeout)
+{
+	int code;
+	HTTP_BUFFERS b = {header, headersize, 0, body, bodysize, 0};
+
+	code = HTTP_ReadStream(socket, _HTTP_BufferSink, &b, timeout);
+	header[b.headerlen] = '\0';
+	body[b.bodylen] = '\0';
+	return code;
+}
+
+/// @cond
+typedef struct
+{
+	TCP_SOCKET socket;
+	TCP_IOVEC iov[HTTP_WRITER_IOV];
+	int cnt;
+	BOOL error;
+} HTTP_WRITER;
+
+//	Writes the queued pieces with one request to the stack, resuming after a
+//	partial write when the TX buffer is full
+static void _HTTP_WriterFlush(HTTP_WRITER * w)
+{
+	int i = 0, retries = HTTP_WRITE_RETRIES;
+	WORD sent;
+
+	while((i < w->cnt) && !w->error)
+	{
+		sent = TCPWriteV(w->socket, &w->iov[i], w->cnt - i);
+		while((i < w->cnt) && (sent >= w->iov[i].len))
+		{
+			sent -= w->iov[i].len;
+			i++;
+		}
+		if(i < w->cnt)
+		{
+			w->iov[i].data += sent;
+			w->iov[i].len -= sent;
+			if(retries-- == 0)
+				w->error = TRUE;
+			else
+				vTaskDelay(1);
+		}
+	}
+	w->cnt = 0;
+}
+
+static void _HTTP_WriterAdd(HTTP_WRITER * w, char * str)
+{
+	int len = strlen(str);
+
+	if(len == 0)
+		return;
+	if(w->cnt == HTTP_WRITER_IOV)
+		_HTTP_WriterFlush(w);
+	w->iov[w->cnt].data = str;
+	w->iov[w->cnt].len = len;
+	w->cnt++;
+	#ifdef DBG_HTTP_SEND
+		_dbgwrite(str);
+	#endif
+}
+
+//	Converts n to decimal digits ending at end, returns the first digit
+static char * _HTTP_UIntToStr(char * end, unsigned int n)
+{
+	*end = '\0';
+	do
+	{
+		*--end = '0' + (n % 10);
+		n /= 10;
+	} while(n > 0);
+	return end;
+}
+/// @endcond
+
+/**
+ * Function to send a request, streaming the request line, the headers and the body straight into the socket TX buffer
+ * \param socket - the handle of the socket to use
+ * \param method - string with the method, e.g. "PUT"
+ * \param host - string with the host (server)
+ * \param path - string with the path (of file) and data, e.g. "/index.php?param1=val1"
+ * \param custom_header - string with custom headers (must include "\r\n", null header = "")
+ * \param CType - string with the Content-Type header, NULL to omit it
+ * \param body - array of strings sent one after the other as body, Content-Length is calculated from them (NULL for no body)
+ * \param bodycnt - number of strings in body
+ * \return 0 if the request was written, -1 if the socket did not accept it
+ */
+int HTTP_SendRequest(TCP_SOCKET socket, char * method, char * host, char * path, char * custom_header, char * CType, char ** body, int bodycnt)
+{
+	HTTP_WRITER w;
+	char lenstr[6];
+	unsigned int bodylen = 0;
+	int i;
+
+	w.socket = socket;
+	w.cnt = 0;
+	w.error = FALSE;
+
+	_HTTP_WriterAdd(&w, method);
+	_HTTP_WriterAdd(&w, " ");
+	_HTTP_WriterAdd(&w, path);
+	_HTTP_WriterAdd(&w, " HTTP/1.1\r\nHOST: ");
+	_HTTP_WriterAdd(&w, host);
+	_HTTP_WriterAdd(&w, "\r\n");
+	if(CType != NULL)
+	{
+		_HTTP_WriterAdd(&w, "Content-Type: ");
+		_HTTP_WriterAdd(&w, CType);
+		_HTTP_WriterAdd(&w, "\r\n");
+	}
+	if(body != NULL)
+	{
+		for(i = 0; i < bodycnt; i++)
+			bodylen += strlen(body[i]);
+		_HTTP_WriterAdd(&w, "Content-Length: ");
+		_HTTP_WriterAdd(&w, _HTTP_UIntToStr(&lenstr[sizeof(lenstr)-1], bodylen));
+		_HTTP_WriterAdd(&w, "\r\n");
+	}
+	_HTTP_WriterAdd(&w, custom_header);
+	_HTTP_WriterAdd(&w, "\r\n");
+	for(i = 0; i < bodycnt; i++)
+		_HTTP_WriterAdd(&w, body[i]);
+	_HTTP_WriterFlush(&w);
+
+	return w.error ? -1 : 0;
+}
+
 /**
  * Function to send a GET request and to receive the response
  * \param socket - the handle of the socket to use
@@ -151,16 +542,10 @@ int HTTP_Read(TCP_SOCKET socket, char * header, int headersize, char * body, int
  */
 int HTTP_Get(TCP_SOCKET socket, char * host, char * path_data, char * custom_header, char * header, int headersize, char * body, int bodysize, int timeout) //multipli di 10ms come vTaskDelay
 {
-	char request[strlen(host)+strlen(path_data)+strlen(custom_header)+50];
-
 	TCPRxFlush(socket);
 	
-	sprintf(request,"GET %s HTTP/1.1\r\nHOST: %s\r\n%s\r\n\r\n", path_data,host,custom_header);
-	#ifdef DBG_HTTP_SEND
-		_dbgwrite(request);
-	#endif
-	
-	TCPWrite(socket,request,strlen(request));
+	if(HTTP_SendRequest(socket, "GET", host, path_data, custom_header, NULL, NULL, 0) != 0)
+		return READ_TIMEOUT;
 	return HTTP_Read(socket, header, headersize, body, bodysize, timeout);
 }
 
@@ -197,16 +582,10 @@ int HTTP_GetSimple(TCP_SOCKET socket, char * host, char * path_data, char * head
  */
 int HTTP_Post(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * CType, char * data, char * header, int headersize, char * body, int bodysize, int timeout) //multipli di 10ms come vTaskDelay
 {
-	char request[strlen(host)+strlen(path)+strlen(custom_header)+strlen(CType)+strlen(data)+100];
-
 	TCPRxFlush(socket);
 	
-	sprintf(request,"POST %s HTTP/1.1\r\nHOST: %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n%s\r\n%s\r\n", path, host, CType, strlen(data), custom_header,data);
-	#ifdef DBG_HTTP_SEND
-		_dbgwrite(request);
-	#endif
-	
-	TCPWrite(socket,request,strlen(request));
+	if(HTTP_SendRequest(socket, "POST", host, path, custom_header, CType, &data, 1) != 0)
+		return READ_TIMEOUT;
 	return HTTP_Read(socket, header, headersize, body, bodysize, timeout);
 }
 
@@ -243,19 +622,33 @@ int HTTP_PostSimple(TCP_SOCKET socket, char * host, char * path, char * data, ch
  */
 int HTTP_Put(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * data, char * header, int headersize, char * body, int bodysize, int timeout) //multipli di 10ms come vTaskDelay
 {
-	char request[strlen(host)+strlen(path)+strlen(custom_header)+strlen(data)+100];
-
 	TCPRxFlush(socket);
 	
-	sprintf(request,"PUT %s HTTP/1.1\r\nHOST: %s\r\nContent-Length: %d\r\n%s\r\n%s\r\n", path, host, strlen(data), custom_header,data);
-	#ifdef DBG_HTTP_SEND
-		_dbgwrite(request);
-	#endif
-	
-	TCPWrite(socket,request,strlen(request));
+	if(HTTP_SendRequest(socket, "PUT", host, path, custom_header, NULL, &data, 1) != 0)
+		return READ_TIMEOUT;
 	return HTTP_Read(socket, header, headersize, body, bodysize, timeout);
 }
 
+/**
+ * Function to send a PUT request and to receive only the HTTP code of the response. The rest of the response is
+ * read from the socket and discarded without being stored, no header or body buffers are needed.
+ * \param socket - the handle of the socket to use
+ * \param host - string with the host (server)
+ * \param path - string with the path (of file), e.g. "/index.php"
+ * \param custom_header - string with custom headers (must include "\r\n", null header = "")
+ * \param data - string with the data, e.g. "param1=val1&param2=val2"
+ * \param timeout - timeout period in 10ms
+ * \return the HTTP code or 0 for timeout
+ */
+int HTTP_PutStatus(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * data, int timeout)
+{
+	TCPRxFlush(socket);
+	
+	if(HTTP_SendRequest(socket, "PUT", host, path, custom_header, NULL, &data, 1) != 0)
+		return READ_TIMEOUT;
+	return HTTP_ReadStatus(socket, timeout);
+}
+
 /**
  * Function to encode a string in a URL string
  * \param dest - pointer in which to store the URL string
@@ -366,6 +759,74 @@ int HTTP_URLDecodeLen(char * str)
 	return lenURL+1;
 }
 
+/**
+ * Function to initialize a persistent connection to a server. No socket is opened until HTTP_ConnOpen is called.
+ * \param conn - pointer to the connection to initialize
+ * \param host - string with the host (server), it must remain valid while the connection is used
+ * \param port - string with the port of the server, e.g. "80"
+ */
+void HTTP_ConnInit(HTTP_CONN * conn, char * host, char * port)
+{
+	conn->host = host;
+	conn->port = port;
+	conn->socket = INVALID_SOCKET;
+	conn->reused = FALSE;
+}
+
+/**
+ * Function to get a connected socket for the persistent connection. The socket opened by a previous call is
+ * reused as long as it is still connected, otherwise (server closed it, never opened) a new one is opened.
+ * The field reused of conn tells whether the returned socket was already connected: a request sent on a reused
+ * socket can race with the server closing it, so on timeout the caller should close the connection and retry once.
+ * \param conn - pointer to the connection
+ * \param timeout - connection timeout period in 10ms
+ * \return the connected socket or INVALID_SOCKET if the connection failed
+ */
+TCP_SOCKET HTTP_ConnOpen(HTTP_CONN * conn, int timeout)
+{
+	int retries;
+
+	if(conn->socket != INVALID_SOCKET)
+	{
+		if(TCPisConn(conn->socket))
+		{
+			conn->reused = TRUE;
+			return conn->socket;
+		}
+		// the server closed the connection, release the stale socket
+		HTTP_ConnClose(conn);
+	}
+
+	conn->reused = FALSE;
+	conn->socket = TCPClientOpen(conn->host, conn->port);
+	if(conn->socket == INVALID_SOCKET)
+		return INVALID_SOCKET;
+
+	for(retries = timeout / HTTP_CONN_POLL_DELAY; !TCPisConn(conn->socket) && retries > 0; retries--)
+		vTaskDelay(HTTP_CONN_POLL_DELAY);
+
+	if(!TCPisConn(conn->socket))
+	{
+		HTTP_ConnClose(conn);
+		return INVALID_SOCKET;
+	}
+	return conn->socket;
+}
+
+/**
+ * Function to close the socket of a persistent connection. The connection can be opened again with HTTP_ConnOpen.
+ * \param conn - pointer to the connection
+ */
+void HTTP_ConnClose(HTTP_CONN * conn)
+{
+	if(conn->socket != INVALID_SOCKET)
+	{
+		TCPClientClose(conn->socket);
+		conn->socket = INVALID_SOCKET;
+	}
+	conn->reused = FALSE;
+}
+
 /*int HTTP_Delete(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * CType, char * data, char * header, int headersize, char * body, int bodysize, int timeout)
 {
 	char request[strlen(host)+strlen(path)+strlen(custom_header)+strlen(data)+100];
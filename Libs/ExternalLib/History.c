@@ -0,0 +1,156 @@
+/*
+ * History
+ * compact in-RAM store of the last readings
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ */
+
+#include "History.h"
+
+/*
+ * Each reading is stored as the difference from the previous one: timestamp
+ * as an unsigned varint, temperature and humidity as zigzag varints, so a
+ * reading a minute apart from the previous one usually takes 3 bytes.
+ * The readings live in a fixed byte ring, the values preceding the oldest
+ * one are kept in _base so it can be dropped without touching the others.
+ */
+
+#define MAX_RECORD_SIZE 11 // 5 bytes timestamp + 3 temperature + 3 humidity
+
+static unsigned char _ring[HIST_SIZE];
+static int _head = 0; // first byte of the oldest reading
+static int _used = 0;
+static int _count = 0;
+static HIST_RECORD _base; // values preceding the oldest reading
+static HIST_RECORD _last; // newest reading
+static DWORD _overwritten = 0;
+
+static void _putVarint(DWORD v)
+{
+    int pos = _head + _used;
+
+    do {
+        unsigned char b = (unsigned char)(v & 0x7F);
+        v >>= 7;
+        if (v != 0) {
+            b |= 0x80;
+        }
+        _ring[pos % HIST_SIZE] = b;
+        ++pos;
+        ++_used;
+    } while (v != 0);
+}
+
+static DWORD _getVarint(int *pos)
+{
+    DWORD v = 0;
+    int shift = 0;
+    unsigned char b;
+
+    do {
+        b = _ring[*pos];
+        *pos = (*pos + 1) % HIST_SIZE;
+        v |= (DWORD)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return v;
+}
+
+static DWORD _zigzag(long v)
+{
+    return (v < 0) ? ((DWORD)(-(v + 1)) << 1) | 1 : (DWORD)v << 1;
+}
+
+static long _unzigzag(DWORD v)
+{
+    return (v & 1) ? -(long)(v >> 1) - 1 : (long)(v >> 1);
+}
+
+/* decodes the reading at pos following prev, returns the position of the next one */
+static int _decode(int pos, const HIST_RECORD *prev, HIST_RECORD *rec)
+{
+    rec->at = prev->at + _getVarint(&pos);
+    rec->t = prev->t + (int)_unzigzag(_getVarint(&pos));
+    rec->hr = prev->hr + (int)_unzigzag(_getVarint(&pos));
+    return pos;
+}
+
+void HIST_Init(void)
+{
+    _head = 0;
+    _used = 0;
+    _count = 0;
+    _overwritten = 0;
+}
+
+void HIST_Add(const HIST_RECORD *rec)
+{
+    while (_count > 0 && HIST_SIZE - _used < MAX_RECORD_SIZE) {
+        HIST_Drop(1);
+        ++_overwritten;
+    }
+    if (0 == _count) {
+        _head = 0;
+        _base = *rec;
+        _last = *rec;
+    }
+    _putVarint(rec->at - _last.at);
+    _putVarint(_zigzag((long)rec->t - _last.t));
+    _putVarint(_zigzag((long)rec->hr - _last.hr));
+    _last = *rec;
+    ++_count;
+}
+
+int HIST_Count(void)
+{
+    return _count;
+}
+
+DWORD HIST_Overwritten(void)
+{
+    return _overwritten;
+}
+
+void HIST_First(HIST_ITER *it)
+{
+    it->pos = _head;
+    it->left = _count;
+    it->prev = _base;
+}
+
+int HIST_Next(HIST_ITER *it, HIST_RECORD *rec)
+{
+    if (it->left <= 0) {
+        return 0;
+    }
+    it->pos = _decode(it->pos, &it->prev, rec);
+    it->prev = *rec;
+    --it->left;
+    return 1;
+}
+
+int HIST_Latest(HIST_RECORD *rec)
+{
+    if (0 == _count) {
+        return 0;
+    }
+    *rec = _last;
+    return 1;
+}
+
+void HIST_Drop(int n)
+{
+    HIST_RECORD rec;
+
+    for (; n > 0 && _count > 0; --n) {
+        int next = _decode(_head, &_base, &rec);
+        _used -= (next - _head + HIST_SIZE) % HIST_SIZE;
+        _head = next;
+        _base = rec;
+        --_count;
+    }
+    if (0 == _count) {
+        _head = 0;
+        _used = 0;
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef CRC8_H_
+#define CRC8_H_
+
+/*
+ * Crc8
+ * CRC-8 used by the DYPTH01 frames and the telemetry datagrams
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ */
+
+/*! CRC-8, polynomial x^8+x^5+x^4+1 (0x31), initial value 0 */
+/*!
+  \param[in] x data
+  \param[in] len number of bytes
+  \return the CRC, 0 when computed over data followed by its own CRC
+*/
+unsigned char CRC8_Calc(const unsigned char *x, int len);
+
+#endif // !CRC8_H_
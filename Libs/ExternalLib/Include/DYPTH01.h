@@ -19,7 +19,7 @@
 */
 void TH01_InitPort(int pin_sdi, int pin_sdo, int pin_sck, int pin_ss_n);
 
-/*! Read last acquired sample */
+/*! Read last acquired sample, blocks until it is transferred */
 /*!
   \param[out] t temperature in 0.1C units
   \param[out] hr relative humidity in percent
@@ -27,4 +27,20 @@ void TH01_InitPort(int pin_sdi, int pin_sdo, int pin_sck, int pin_ss_n);
 */
 int TH01_ReadData(int *t, int *hr);
 
+/*! Starts transferring the last acquired sample and returns at once */
+/*! The SPI2 interrupt receives the frame, collect it with TH01_WaitData */
+void TH01_StartRead(void);
+
+/*! Waits for the sample requested by TH01_StartRead */
+/*!
+  \param[out] t temperature in 0.1C units
+  \param[out] hr relative humidity in percent
+  \param[in] timeout max wait in RTOS ticks (1ms, not the 10ms of vTaskDelay), 0 just checks if the sample is in
+  \return 0=ok, 1=timeout_error (transfer aborted), 2=crc_error, 3=not_ready (timeout 0 only)
+*/
+int TH01_WaitData(int *t, int *hr, unsigned int timeout);
+
+/*! Number of frames rejected for a wrong CRC since power on */
+unsigned int TH01_GetCrcErrors(void);
+
 #endif // !DYPTH01_H_
@@ -13,25 +13,55 @@
 
 #define ARRAY_SIZE(x) (sizeof(x)-1)
 
-#define HTTP_MAX_SIZE 2000 // originally 5000
+#define HTTP_CHUNK_SIZE 32 // bytes read from the socket at once while parsing
+#define HTTP_LINE_SIZE 32 // header line prefix kept to find Content-Length and Transfer-Encoding
+#define HTTP_WRITER_IOV 16 // request pieces written to the socket at once
+#define HTTP_WRITE_RETRIES 50 // 1 tick waits for room in the TX buffer
+
+#define HTTP_TICKS(t) ((portTickType)(((DWORD)(t) * 10) / portTICK_RATE_MS)) // timeout in 10ms to RTOS ticks
 
 #define READ_TIMEOUT 0
 #define OK_200 200
 #define CREATED_201 201
 #define FORBIDDEN_403 403
 
+#define HTTP_CONN_POLL_DELAY 20
+
+#define HTTP_SINK_HEADER 0
+#define HTTP_SINK_BODY 1
+
+/// Receives the pieces of a response while it is parsed (event is HTTP_SINK_HEADER or HTTP_SINK_BODY)
+typedef void (*HTTP_SINK)(void * ctx, int event, char * data, int len);
+
+/// Persistent (keep-alive) connection to a single HTTP server
+typedef struct
+{
+	char * host;
+	char * port;
+	TCP_SOCKET socket;
+	BOOL reused;
+} HTTP_CONN;
+
 /*****************************************************************************
         HTTP function declarations
 *****************************************************************************/
 
+int HTTP_SendRequest(TCP_SOCKET socket, char * method, char * host, char * path, char * custom_header, char * CType, char ** body, int bodycnt);
 int HTTP_Get(TCP_SOCKET socket, char * host, char * path_data, char * custom_header, char * header, int headersize, char * body, int bodysize, int timeout);
 int HTTP_GetSimple(TCP_SOCKET socket, char * host, char * path_data, char * header, int headersize, char * body, int bodysize);
 int HTTP_Post(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * CType, char * data, char * header, int headersize, char * body, int bodysize, int timeout);
 int HTTP_PostSimple(TCP_SOCKET socket, char * host, char * path, char * data, char * header, int headersize, char * body, int bodysize);
 int HTTP_Put(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * data, char * header, int headersize, char * body, int bodysize, int timeout);
+int HTTP_PutStatus(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * data, int timeout);
 //int HTTP_Delete(TCP_SOCKET socket, char * host, char * path, char * custom_header, char * CType, char * data, char * header, int headersize, char * body, int bodysize, int timeout);
 void HTTP_URLEncode(char * dest, char * src);
 int HTTP_URLEncodeLen(char * str);
 void HTTP_URLDecode(char * dest, char * src);
 int HTTP_URLDecodeLen(char * str);
 int HTTP_Read(TCP_SOCKET socket, char * header, int headersize, char * body, int bodysize, int timeout);
+int HTTP_ReadStream(TCP_SOCKET socket, HTTP_SINK sink, void * ctx, int timeout);
+int HTTP_ReadStatus(TCP_SOCKET socket, int timeout);
+
+void HTTP_ConnInit(HTTP_CONN * conn, char * host, char * port);
+TCP_SOCKET HTTP_ConnOpen(HTTP_CONN * conn, int timeout);
+void HTTP_ConnClose(HTTP_CONN * conn);
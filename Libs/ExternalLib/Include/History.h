@@ -0,0 +1,71 @@
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+/*
+ * History
+ * compact in-RAM store of the last readings
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ */
+
+#include "GenericTypeDefs.h"
+
+#define HIST_SIZE 512 // bytes of the ring, a reading every minute takes about 3 bytes
+
+/*! A reading */
+typedef struct {
+    DWORD at; /*!< timestamp, UTC seconds */
+    int t; /*!< temperature in 0.1C units */
+    int hr; /*!< relative humidity in percent */
+} HIST_RECORD;
+
+/*! Position inside the history, used to walk the readings from the oldest */
+typedef struct {
+    int pos;
+    int left;
+    HIST_RECORD prev;
+} HIST_ITER;
+
+/*! Empties the history */
+void HIST_Init(void);
+
+/*! Stores a reading as the newest, dropping the oldest ones if there is no room */
+/*!
+  \param[in] rec the reading
+*/
+void HIST_Add(const HIST_RECORD *rec);
+
+/*! Number of readings stored */
+int HIST_Count(void);
+
+/*! Readings dropped to make room since HIST_Init */
+DWORD HIST_Overwritten(void);
+
+/*! Starts walking the readings from the oldest */
+/*!
+  \param[out] it iterator to initialize
+*/
+void HIST_First(HIST_ITER *it);
+
+/*! Gets the next reading */
+/*!
+  \param[in,out] it iterator
+  \param[out] rec the reading
+  \return 1 if rec was filled, 0 when there are no more readings
+*/
+int HIST_Next(HIST_ITER *it, HIST_RECORD *rec);
+
+/*! Gets the newest reading */
+/*!
+  \param[out] rec the reading
+  \return 1 if rec was filled, 0 if the history is empty
+*/
+int HIST_Latest(HIST_RECORD *rec);
+
+/*! Removes the oldest readings, e.g. once they have been uploaded */
+/*!
+  \param[in] n number of readings to remove
+*/
+void HIST_Drop(int n);
+
+#endif // !HISTORY_H_
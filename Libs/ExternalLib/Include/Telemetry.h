@@ -0,0 +1,46 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/*
+ * Telemetry
+ * publishes the readings as binary datagrams to a UDP multicast group
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ */
+
+#include "GenericTypeDefs.h"
+#include "History.h"
+
+/*
+ * Datagram layout, multi-byte fields big endian:
+ *   0     version, TELEM_VERSION
+ *   1-6   device id, MAC address of the module
+ *   7-8   sequence number, wraps around
+ *   9-12  timestamp, UTC seconds
+ *   13-14 temperature in 0.1C units, signed
+ *   15    relative humidity in percent
+ *   16    CRC-8 of bytes 0-15, see Crc8.h
+ * test/telemetry_listener.c receives and decodes them on a PC.
+ */
+#define TELEM_VERSION 1
+#define TELEM_PACKET_SIZE 17
+
+/*! Opens the socket and joins the multicast group */
+/*!
+  \param[in] group multicast address, e.g. "239.255.42.1"
+  \param[in] port UDP port of the listeners
+  \return TRUE when the socket is open
+*/
+BOOL TELEM_Open(char *group, char *port);
+
+/*! Sends a reading to the group */
+/*!
+  \param[in] rec the reading
+  \return TRUE when the datagram has been handed to the stack
+*/
+BOOL TELEM_Publish(const HIST_RECORD *rec);
+
+/*! Number of readings that could not be sent */
+unsigned int TELEM_GetErrors(void);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,55 @@
+/*
+ * Telemetry
+ * publishes the readings as binary datagrams to a UDP multicast group
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ */
+
+#include <string.h>
+#include "Telemetry.h"
+#include "Crc8.h"
+#include "UDPlib.h"
+
+static BYTE _sock = 0; // 0 when not open, as returned by UDPMultiOpen on failure
+static WORD _seq = 0;
+static unsigned int _errors = 0;
+
+BOOL TELEM_Open(char *group, char *port)
+{
+    _sock = UDPMultiOpen(group, port);
+    return _sock != 0;
+}
+
+BOOL TELEM_Publish(const HIST_RECORD *rec)
+{
+    BYTE pkt[TELEM_PACKET_SIZE];
+
+    if (_sock == 0) {
+        ++_errors;
+        return FALSE;
+    }
+    pkt[0] = TELEM_VERSION;
+    memcpy(&pkt[1], AppConfig.MyMACAddr.v, 6);
+    pkt[7] = (BYTE)(_seq >> 8);
+    pkt[8] = (BYTE)_seq;
+    pkt[9] = (BYTE)(rec->at >> 24);
+    pkt[10] = (BYTE)(rec->at >> 16);
+    pkt[11] = (BYTE)(rec->at >> 8);
+    pkt[12] = (BYTE)rec->at;
+    pkt[13] = (BYTE)((WORD)rec->t >> 8);
+    pkt[14] = (BYTE)rec->t;
+    pkt[15] = (BYTE)rec->hr;
+    pkt[16] = CRC8_Calc(pkt, TELEM_PACKET_SIZE - 1);
+    ++_seq;
+
+    if (UDPWrite(_sock, pkt, TELEM_PACKET_SIZE) != TELEM_PACKET_SIZE) {
+        ++_errors;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+unsigned int TELEM_GetErrors(void)
+{
+    return _errors;
+}
@@ -65,7 +65,6 @@ but usually this operation in managed by TCP-IP Stack.
 
 #include "ARPlib.h"
 
-static int ToSend = 0; 
 
 /**
  * Force an arp request for specific IP address
@@ -74,49 +73,31 @@ static int ToSend = 0;
 BYTE ARPResolveMAC(char ipaddr[])
 {
 	BYTE retsock;
-	BOOL opok = FALSE;
-	while (!opok)
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->str = ipaddr;
+	if (FrontEndCall(req, ARP_RESOLVE) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			xFrontEndStatRet = 2;	
-			ToSend=ARP_RESOLVE;
-			memcpy((char*)xIPAddress,ipaddr,17);
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xErr = ARP_RESOLVE; //ToSend;
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return 0;
-		}
+		FrontEndUnlock(req);
+		return 0;
 	}
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
 	retsock = 0;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FrontEndUnlock(req);
 	return retsock;
 }
 
 /// @cond debug
 //	ARPResolveMAC callback function
-int cARPResolveMAC()
+int cARPResolveMAC(FRONTEND_REQ* req)
 {	
 	IP_ADDR dummyIP;
-	dummyIP.Val = ( ((DWORD) xIPAddress[0]) +
-					((DWORD) xIPAddress[1] << 8) +
-					((DWORD) xIPAddress[2] << 16) +
-					((DWORD) xIPAddress[3] << 24) );
+	BYTE* ipaddr = (BYTE*) req->str;
+	dummyIP.Val = ( ((DWORD) ipaddr[0]) +
+					((DWORD) ipaddr[1] << 8) +
+					((DWORD) ipaddr[2] << 16) +
+					((DWORD) ipaddr[3] << 24) );
 	
 	ARPResolve(&dummyIP);
 	return 0;
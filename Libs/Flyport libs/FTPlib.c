@@ -86,7 +86,6 @@ static int FTPwFile(TCP_SOCKET cmdSock, char fileName[], char appStr[], char wMo
 //	Static variables
 static TCP_SOCKET dataSocket = INVALID_SOCKET;
 static int streamStat = 0;
-static int ToSend = 0; 
 static long streamLen = 0;
 static long streamRBytes = 0;
 
@@ -263,8 +262,6 @@ TCP_SOCKET FTPClientPasv(TCP_SOCKET sockpasv, char ServerName[])
 		indsub++;
 	}
 
-	xFrontEndStatRet = 2;	
-	ToSend=20;
 	sprintf(ServerName, "%s", servReply);
 	return TCPGenericOpen(ServerName, TCP_OPEN_RAM_HOST , word1 , 4);	
 }
@@ -279,13 +276,15 @@ int FTPSendCmd(TCP_SOCKET cmdSock, char *cmdStr, char* res, int resLen)
 	int wBytes = 0;
 	BOOL chkWrite = TRUE;
 	
-	//	Sending FTP command
+	//	Sending FTP command, in a single segment
+	TCPCork(cmdSock, TRUE);
 	wBytes = FTPMultiWrite(cmdSock, (BYTE*)cmdStr, strlen(cmdStr));
 	if (wBytes < strlen(cmdStr))
 		chkWrite = FALSE;
 	wBytes = FTPMultiWrite(cmdSock, (BYTE*)"\r\n", 2);
 	if (wBytes < 2)
 		chkWrite = FALSE;
+	TCPCork(cmdSock, FALSE);
 		
 	if (!chkWrite)
 	{
@@ -390,9 +389,11 @@ int FTPConnect(TCP_SOCKET *FTPConn, char *ftp_addr, char ftp_port[], char ftp_us
 	
 	
  	//	#2 - SENDING USERNAME TO SERVER
+ 	TCPCork(*FTPConn, TRUE);
  	FTPMultiWrite(*FTPConn, (BYTE*)"USER ", 5);
  	FTPMultiWrite(*FTPConn, (BYTE*)ftp_usr, strlen(ftp_usr));
  	FTPMultiWrite(*FTPConn, (BYTE*)"\r\n", 2);
+ 	TCPCork(*FTPConn, FALSE);
 
 	code_rep = FTPAnswer(*FTPConn, code);
 	//	EXCEPTION HANDLING: server timeout
@@ -422,10 +423,12 @@ int FTPConnect(TCP_SOCKET *FTPConn, char *ftp_addr, char ftp_port[], char ftp_us
  		
  		
  	// #3 - SENDING PASSWORD TO SERVER
+  	TCPCork(*FTPConn, TRUE);
   	FTPMultiWrite(*FTPConn, (BYTE*)"PASS ", 5);
 	if (ftp_pwd != FTP_NO_PASS)
 		FTPMultiWrite(*FTPConn, (BYTE*)ftp_pwd, strlen(ftp_pwd));
  	FTPMultiWrite(*FTPConn, (BYTE*)"\r\n", 2);
+ 	TCPCork(*FTPConn, FALSE);
 	
 	code_rep = FTPAnswer(*FTPConn, code);
 	//	EXCEPTION HANDLING: server timeout
@@ -487,9 +490,11 @@ int FTPFileCheck(TCP_SOCKET cmdSock, char fileToCheck[])
 		return FTP_SOCK_NOT_CONNECTED;
 	//	#1 - Sending SIZE command	
 	FTPRxFlush(cmdSock, 100);
+	TCPCork(cmdSock, TRUE);
 	FTPMultiWrite(cmdSock, (BYTE*)"SIZE ",5);
 	FTPMultiWrite(cmdSock, (BYTE*)fileToCheck, strlen(fileToCheck));
 	FTPMultiWrite(cmdSock, (BYTE*)"\r\n", 2);
+	TCPCork(cmdSock, FALSE);
 
 	//	#2 - Reading answer from server
 	servReply = FTPAnswer(cmdSock, code);
@@ -581,6 +586,7 @@ static int FTPwFile(TCP_SOCKET cmdSock, char fileName[], char appStr[], char wMo
 	}	
 	
 	//	#2 - Append file command APPE, check on TX chars and answer handling
+	TCPCork(cmdSock, TRUE);
 	wBytes = FTPMultiWrite(cmdSock, (BYTE*)wMode,5);
 	if (wBytes < 5)
 		chkWrite = FALSE;
@@ -590,6 +596,7 @@ static int FTPwFile(TCP_SOCKET cmdSock, char fileName[], char appStr[], char wMo
 	wBytes = FTPMultiWrite(cmdSock, (BYTE*)"\r\n", 2);
 	if (wBytes < 2)
 		chkWrite = FALSE;
+	TCPCork(cmdSock, FALSE);
 	if (!chkWrite)
 	{
 		if (FTPisConn(cmdSock))
@@ -714,9 +721,11 @@ int FTPStreamOpen(TCP_SOCKET cmdSock, char fileName[], char mode[])
 		}	
 		
 		//	Append file command APPE/STOR/RETR...
+		TCPCork(cmdSock, TRUE);
 		FTPMultiWrite(cmdSock, (BYTE*)mode,5);
 		FTPMultiWrite(cmdSock, (BYTE*)fileName, strlen(fileName));
 		FTPMultiWrite(cmdSock, (BYTE*)"\r\n", 2);
+		TCPCork(cmdSock, FALSE);
 		//	Reading answer from server
 		servReply = FTPAnswer(cmdSock, code);
 		if (servReply != 0)
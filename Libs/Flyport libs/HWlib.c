@@ -56,6 +56,7 @@
  **************************************************************************/
 /// @cond debug
 #include "HWlib.h"
+#include "RingCopy.h"
 #include "p24FJ256GA106.h"
 #if defined (FLYPORTGPRS)
 #include "Tick.h"
@@ -152,6 +153,28 @@ static char Buffer4[UART_BUFFER_SIZE_4];
 static char buffover [MAX_UART_PORTS];
 static BYTE last_op[MAX_UART_PORTS];
 
+//	TX rings: the tasks write at txind_w, the TX interrupt reads at txind_r
+static volatile int txind_w[4];
+static volatile int txind_r[4];
+static char* UartTxBuffers[UART_PORTS];
+static int	 UartTxSize[UART_PORTS];
+static BYTE tx_policy[MAX_UART_PORTS];
+static portTickType tx_timeout[MAX_UART_PORTS];
+static unsigned int tx_dropped[MAX_UART_PORTS];
+
+#if UART_PORTS >= 1
+static char TxBuffer1[UART_TX_BUFFER_SIZE_1];
+#endif
+#if UART_PORTS >= 2
+static char TxBuffer2[UART_TX_BUFFER_SIZE_2];
+#endif
+#if UART_PORTS >= 3
+static char TxBuffer3[UART_TX_BUFFER_SIZE_3];
+#endif
+#if UART_PORTS >= 4
+static char TxBuffer4[UART_TX_BUFFER_SIZE_4];
+#endif
+
 static int OCTimer[9];
 static char OCTSel[9];
 BOOL TimerOn[5];
@@ -630,7 +653,7 @@ void PowerLed(int val)
 /**
 \defgroup UART
 @{
-The UART section provides serial communication. The flyport implements a buffer of 256 characters for the UART, to make serial communicate easier.
+The UART section provides serial communication. The flyport implements a buffer of 256 characters for the UART, to make serial communicate easier. The characters to send are queued in a TX buffer emptied by the TX interrupt, so UARTWrite returns without waiting for the transmission; UARTTxPolicy sets what happens when the TX buffer is full.
 */
 
 
@@ -653,6 +676,8 @@ void UARTInit(int port,long int baud)
 			case 0:
 				UartSize[port] = UART_BUFFER_SIZE_1;
 				UartBuffers[port] = Buffer1;
+				UartTxSize[port] = UART_TX_BUFFER_SIZE_1;
+				UartTxBuffers[port] = TxBuffer1;
 				break;
 			#endif
 			
@@ -660,6 +685,8 @@ void UARTInit(int port,long int baud)
 			case 1:
 				UartSize[port] = UART_BUFFER_SIZE_2;
 				UartBuffers[port] = Buffer2;
+				UartTxSize[port] = UART_TX_BUFFER_SIZE_2;
+				UartTxBuffers[port] = TxBuffer2;
 				break;
 			#endif
 			
@@ -667,6 +694,8 @@ void UARTInit(int port,long int baud)
 			case 2:
 				UartSize[port] = UART_BUFFER_SIZE_3;
 				UartBuffers[port] = Buffer3;
+				UartTxSize[port] = UART_TX_BUFFER_SIZE_3;
+				UartTxBuffers[port] = TxBuffer3;
 				break;
 			#endif
 			
@@ -674,12 +703,17 @@ void UARTInit(int port,long int baud)
 			case 3:
 				UartSize[port] = UART_BUFFER_SIZE_4;
 				UartBuffers[port] = Buffer4;
+				UartTxSize[port] = UART_TX_BUFFER_SIZE_4;
+				UartTxBuffers[port] = TxBuffer4;
 				break;
 			#endif
 			
 			default:
 				break;
 		}
+		tx_policy[port] = UART_TX_DEF_POLICY;
+		tx_timeout[port] = UART_TX_DEF_TIMEOUT;
+		tx_dropped[port] = 0;
 		long int brg , baudcalc , clk , err;
 		clk = GetInstructionClock();
 		brg = (clk/(baud*16ul))-1;
@@ -721,9 +755,32 @@ void UARTOn(int port)
 		*UIFSs[port] = *UIFSs[port] & (~URXIPos[port]);
 		*UIFSs[port] = *UIFSs[port] & (~UTXIPos[port]);
 		*UIECs[port] = *UIECs[port] | URXIPos[port];
+		//	The TX interrupt runs at the kernel priority, so taskENTER_CRITICAL 
+		//	keeps it out while a task updates the TX ring and the IEC register
+		switch(port)
+		{
+			case 0:
+				IPC3bits.U1TXIP = configKERNEL_INTERRUPT_PRIORITY;
+				break;
+			case 1:
+				IPC7bits.U2TXIP = configKERNEL_INTERRUPT_PRIORITY;
+				break;
+			case 2:
+				IPC20bits.U3TXIP = configKERNEL_INTERRUPT_PRIORITY;
+				break;
+			#if !defined (FLYPORTGPRS)
+			case 3:
+				IPC22bits.U4TXIP = configKERNEL_INTERRUPT_PRIORITY;
+				break;
+			#endif
+			default:
+				break;
+		}
 		bufind_w[port] = 0;
 		bufind_r[port] = 0;
 		last_op[port] = 0;
+		txind_w[port] = 0;
+		txind_r[port] = 0;
 	#if defined (FLYPORTGPRS)
 	}
 	#endif
@@ -787,6 +844,141 @@ void UARTRxInt(int port)
 	last_op[port] = 1;	
 	*UIFSs[port] = *UIFSs[port] & (~URXIPos[port]);
 }
+
+//	Moves the queued characters to the TX FIFO while it has room
+static void _UARTTxFill(int port)
+{
+	int pdsel = (*UMODEs[port] & 6) >>1;
+	while (((*USTAs[port] & 512) == 0) && (txind_r[port] != txind_w[port]))
+	{
+		char chr = *(UartTxBuffers[port]+txind_r[port]);
+		if (pdsel == 3)							// checks if TX is 8bits or 9bits
+			*UTXREGs[port] = chr;
+		else
+			*UTXREGs[port] = chr & 0xFF;
+		if (txind_r[port] == UartTxSize[port] - 1)
+			txind_r[port] = 0;
+		else
+			txind_r[port]++;
+	}
+}
+
+/*---------------------------------------------------------------------------- 
+  |	Function: 		UARTTxInt(int port)		 								 |
+  | Description: 	Specific funtion to write the UART from inside the ISR.	 |
+  |					It empties the TX ring, then turns itself off			 |
+  | Returns:		-														 |
+  | Parameters:		int port - specifies the port (1 to 4)					 |
+  --------------------------------------------------------------------------*/
+void UARTTxInt(int port)
+{
+	port--;
+	*UIFSs[port] = *UIFSs[port] & (~UTXIPos[port]);
+	_UARTTxFill(port);
+	if (txind_r[port] == txind_w[port])
+		*UIECs[port] = *UIECs[port] & (~UTXIPos[port]);
+}
+
+//	Primes the TX FIFO and lets the interrupt send the rest of the ring. 
+//	Called inside a critical section: the TX interrupt, at the kernel 
+//	priority, can't change the IEC register between its read and write
+static void _UARTTxStart(int port)
+{
+	*UIECs[port] = *UIECs[port] & (~UTXIPos[port]);
+	_UARTTxFill(port);
+	if (txind_r[port] != txind_w[port])
+		*UIECs[port] = *UIECs[port] | UTXIPos[port];
+}
+
+//	Free bytes in the TX ring, one is kept empty to tell a full ring from an empty one
+static int _UARTTxRoom(int port)
+{
+	if (UartTxSize[port] == 0)		// UARTInit not called yet
+		return 0;
+	int room = txind_r[port] - txind_w[port] - 1;
+	if (room < 0)
+		room += UartTxSize[port];
+	return room;
+}
+
+//	Copies to the TX ring as many characters as fit, returns their number
+static int _UARTTxPut(int port, char *buffer, int count)
+{
+	int room = _UARTTxRoom(port);
+	if (count > room)
+		count = room;
+	//	Bytes up to the end of the ring, the rest goes at its start
+	int itx = UartTxSize[port] - txind_w[port];
+	if (itx > count)
+		itx = count;
+	memcpy(UartTxBuffers[port]+txind_w[port], buffer, itx);
+	if (count > itx)
+		memcpy(UartTxBuffers[port], buffer+itx, count-itx);
+	if (txind_w[port] + count >= UartTxSize[port])
+		txind_w[port] = txind_w[port] + count - UartTxSize[port];
+	else
+		txind_w[port] += count;
+	return count;
+}
+
+//	Sends the whole TX ring by polling, with the TX interrupt off. 
+//	Returns FALSE if the UART is off, since nothing would be sent
+static BOOL _UARTTxFlush(int port)
+{
+	if ((*UMODEs[port] & 0x8000) == 0)
+		return FALSE;
+	*UIECs[port] = *UIECs[port] & (~UTXIPos[port]);
+	while (txind_r[port] != txind_w[port])
+		_UARTTxFill(port);
+	return TRUE;
+}
+
+//	Queues count characters following the policy of the port, in pieces 
+//	that fit in the empty TX ring
+static void _UARTTxWrite(int port, char *buffer, int count)
+{
+	portTickType start = xTaskGetTickCount();
+	int sent = 0;
+	int piece, put;
+
+	while ((sent < count) && (UartTxSize[port] > 0))
+	{
+		piece = count - sent;
+		if (piece > UartTxSize[port] - 1)
+			piece = UartTxSize[port] - 1;
+		//	The critical section masks the TX interrupt and the task switches: 
+		//	no other task writes the ring meanwhile, so the pieces of different 
+		//	strings don't mix, and the ISR doesn't touch txind_r or the IEC 
+		//	register until _UARTTxStart is done
+		taskENTER_CRITICAL();
+		if ((tx_policy[port] == UART_TX_DROP) && (piece > _UARTTxRoom(port)))
+			put = 0;
+		else
+			put = _UARTTxPut(port, buffer+sent, piece);
+		_UARTTxStart(port);
+		taskEXIT_CRITICAL();
+		sent += put;
+		if (put == piece)
+			continue;
+		if (tx_policy[port] != UART_TX_BLOCK)
+			break;
+		//	Turned off by UARTOff, the ring won't be emptied: the rest is dropped
+		if ((*UMODEs[port] & 0x8000) == 0)
+			break;
+		if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		{
+			//	No other task can run, the ring is sent here
+			if (!_UARTTxFlush(port))
+				break;
+		}
+		else if ((tx_timeout[port] != portMAX_DELAY) && 
+				((portTickType) (xTaskGetTickCount() - start) >= tx_timeout[port]))
+			break;
+		else
+			vTaskDelay(1);		//	the TX interrupt makes room meanwhile
+	}
+	tx_dropped[port] += count - sent;
+}
 /// @endcond
 
 
@@ -869,19 +1061,8 @@ int UARTRead(int port , char *towrite , int count)
 		if (count > limit)
 			count=limit;
 		port = port-1;
-		int irx = 0;
 		rd = 0;
-		while (irx < count)
-		{
-			*(towrite+irx) = *(UartBuffers[port]+bufind_r[port]);
-
-			if (bufind_r[port] == UartSize[port]-1)
-				bufind_r[port] = 0;
-			else
-				bufind_r[port]++;		
-
-			irx++;
-		}
+		bufind_r[port] = RingRead(towrite, UartBuffers[port], UartSize[port], bufind_r[port], count);
 		
 		if ( buffover [port] != 0 )
 		{
@@ -915,25 +1096,7 @@ void UARTWrite(int port, char *buffer)
 	{
 	#endif
 		port--;
-		int pdsel;
-		// transmits till NUL character is encountered 
-		pdsel = (*UMODEs[port] & 6) >>1;
-		if (pdsel == 3)                             // checks if TX is 8bits or 9bits
-		{
-			while(*buffer != '\0') 
-			{
-				while((*USTAs[port] & 512)>0);	// waits if the buffer is full 
-				*UTXREGs[port] = *buffer++;         // sends char to TX reg
-			}
-		}
-		else
-		{
-			while(*buffer != '\0')
-			{
-				while((*USTAs[port] & 512)>0);      // sends char to TX reg
-				*UTXREGs[port] = *buffer++ & 0xFF;  // sends char to TX reg
-			}
-		}
+		_UARTTxWrite(port, buffer, strlen(buffer));
 	#if defined (FLYPORTGPRS)
 	}
 	#endif
@@ -953,18 +1116,81 @@ void UARTWriteCh(int port, char chr)
 	{
 	#endif
 		port--;
-		int pdsel;
-		pdsel = (*UMODEs[port] & 6) >>1;
-		if(pdsel == 3)        /* checks if TX is 8bits or 9bits */
-		{
-			while((*USTAs[port] & 512)>0);	/* waits if the buffer is full */
-			*UTXREGs[port] = chr;    		/* transfer data to TX reg */
-		}
-		else
-		{
-			while((*USTAs[port] & 512)>0); /* waits if the buffer is full */
-			*UTXREGs[port] = chr & 0xFF;   /* transfer data to TX reg */
-		}
+		_UARTTxWrite(port, &chr, 1);
+	#if defined (FLYPORTGPRS)
+	}
+	#endif
+}
+
+
+ /**
+ * Sets what UARTWrite and UARTWriteCh do when the TX buffer of the port is full. Strings longer than the buffer are queued in pieces, each one handled by the policy.
+ * \param port - the UART port. <B><I>Note:</B> port 4 not available for Flyport GPRS</I>
+ * \param policy - one of:
+  <UL>
+	<LI><B>UART_TX_DROP:</B> the piece that doesn't fit and the rest of the string are discarded.</LI> 
+	<LI><B>UART_TX_BLOCK:</B> the task sleeps while the TX interrupt makes room, up to timeout (default).</LI> 
+	<LI><B>UART_TX_TRUNCATE:</B> the part of the string that fits is sent.</LI> 
+ </UL>
+ * \param timeout - RTOS ticks to wait for UART_TX_BLOCK, the rest of the string is discarded after it. portMAX_DELAY (default) waits until the whole string is queued.
+ * \return None
+ */
+void UARTTxPolicy(int port, BYTE policy, portTickType timeout)
+{
+	#if defined (FLYPORTGPRS)
+	if(port < 4)
+	{
+	#endif
+		port--;
+		tx_policy[port] = policy;
+		tx_timeout[port] = timeout;
+	#if defined (FLYPORTGPRS)
+	}
+	#endif
+}
+
+
+ /**
+ * Returns the number of characters discarded because the TX buffer was full.
+ * \param port - the UART port. <B><I>Note:</B> port 4 not available for Flyport GPRS</I>
+ * \param reset - TRUE to restart the count.
+ * \return the characters discarded since UARTInit or the last reset.
+ */
+unsigned int UARTTxDropped(int port, BOOL reset)
+{
+	#if defined (FLYPORTGPRS)
+	if(port < 4)
+	{
+	#endif
+		port--;
+		unsigned int dropped = tx_dropped[port];
+		if (reset)
+			tx_dropped[port] = 0;
+		return dropped;
+	#if defined (FLYPORTGPRS)
+	}
+	else
+		return 0;
+	#endif
+}
+
+
+ /**
+ * Sends all the characters in the TX buffer without using the interrupt, then waits the end of the transmission. 
+ * To use where the TX interrupt can't run, like inside the trap handlers, or before a reset.
+ * \param port - the UART port. <B><I>Note:</B> port 4 not available for Flyport GPRS</I>
+ * \return None
+ */
+void UARTTxDrain(int port)
+{
+	#if defined (FLYPORTGPRS)
+	if(port < 4)
+	{
+	#endif
+		port--;
+		if (!_UARTTxFlush(port))
+			return;
+		while ((*USTAs[port] & 256) == 0);		// waits the shift register to be empty
 	#if defined (FLYPORTGPRS)
 	}
 	#endif
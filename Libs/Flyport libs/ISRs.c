@@ -34,31 +34,67 @@ void __attribute__((interrupt, no_auto_psv)) _U4RXInterrupt(void)
 #endif
 }
 
+void __attribute__((interrupt, no_auto_psv)) _U1TXInterrupt(void)
+{
+	UARTTxInt(1);
+}
+
+void __attribute__((interrupt, no_auto_psv)) _U2TXInterrupt(void)
+{
+#if UART_PORTS >= 2
+	UARTTxInt(2);
+#endif
+}
+
+void __attribute__((interrupt, no_auto_psv)) _U3TXInterrupt(void)
+{
+#if UART_PORTS >= 3
+	UARTTxInt(3);
+#endif
+}
+
+void __attribute__((interrupt, no_auto_psv)) _U4TXInterrupt(void)
+{
+#if UART_PORTS == 4
+	UARTTxInt(4);
+#endif
+}
+
 
 void __attribute__((interrupt, auto_psv)) _DefaultInterrupt(void)
 {
+	UARTTxDrain(1);
 	_dbgwrite("!!! Default interrupt handler !!!\r\n" );
+	UARTTxDrain(1);
 	Reset();
 }
 
 void __attribute__((interrupt, auto_psv)) _OscillatorFail(void)
 {
+	UARTTxDrain(1);
 	_dbgwrite("!!! Oscillator Fail interrupt handler !!!\r\n" );
+	UARTTxDrain(1);
 	Reset();
 }
 void __attribute__((interrupt, auto_psv)) _AddressError(void)
 {
+	UARTTxDrain(1);
 	_dbgwrite("!!! Address Error interrupt handler !!!\r\n" );
+	UARTTxDrain(1);
 	Reset();
 }
 void __attribute__((interrupt, auto_psv)) _StackError(void)
 {
+	UARTTxDrain(1);
 	_dbgwrite("!!! Stack Error interrupt handler !!!\r\n" );
+	UARTTxDrain(1);
 	Reset();
 }
 void __attribute__((interrupt, auto_psv)) _MathError(void)
 {
+	UARTTxDrain(1);
 	_dbgwrite("!!! Math Error interrupt handler !!!\r\n" );
+	UARTTxDrain(1);
 	Reset();
 }
 
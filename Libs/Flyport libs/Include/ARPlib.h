@@ -48,6 +48,7 @@
 #ifndef __ARPLIB_H
 #define __ARPLIB_H
 #include "TCPIP Stack/TCPIP.h"
+#include "FrontEnd.h"
 
 #define ARP_RESOLVE 34
 
@@ -56,14 +57,12 @@ extern BYTE xIPAddress[];
 
 //	Frontend variables
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 
 
 BYTE ARPResolveMAC(char* IPaddr);
-int cARPResolveMAC();
+int cARPResolveMAC(FRONTEND_REQ*);
 #endif
@@ -82,23 +82,12 @@
 
 //	Frontend variables
 extern BYTE xIPAddress[];
-extern WORD xTCPPort;
-extern TCP_SOCKET xSocket;
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
-extern BOOL xBool;
-extern WORD xWord;
-extern char *xChar;
-extern BYTE *xByte;
-extern BYTE xByte2;
-extern BYTE xByte3;
-extern int xInt;
 
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 
 /*****************************************************************************
 	FTP function declarations	
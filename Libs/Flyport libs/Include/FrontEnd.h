@@ -0,0 +1,118 @@
+/* **************************************************************************																					
+ *                                OpenPicus                 www.openpicus.com
+ *                                                            italian concept
+ * 
+ *            openSource wireless Platform for sensors and Internet of Things	
+ * **************************************************************************
+ *  FileName:        FrontEnd.h
+ *  Dependencies:    FreeRTOS
+ *  Module:          FlyPort WI-FI
+ *  Compiler:        Microchip C30 v3.12 or higher
+ *
+ *  Software License Agreement
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  This is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License (version 2) as published by 
+ *  the Free Software Foundation AND MODIFIED BY OpenPicus team.
+ *  
+ *  ***NOTE*** The exception to the GPL is included to allow you to distribute
+ *  a combined work that includes OpenPicus code without being obliged to 
+ *  provide the source code for proprietary components outside of the OpenPicus
+ *  code. 
+ *  OpenPicus software is distributed in the hope that it will be useful, but 
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details. 
+ * 
+ * 
+ * Warranty
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * THE SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT
+ * WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTY OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * WE ARE LIABLE FOR ANY INCIDENTAL, SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF
+ * PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY OR SERVICES, ANY CLAIMS
+ * BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE
+ * THEREOF), ANY CLAIMS FOR INDEMNITY OR CONTRIBUTION, OR OTHER
+ * SIMILAR COSTS, WHETHER ASSERTED ON THE BASIS OF CONTRACT, TORT
+ * (INCLUDING NEGLIGENCE), BREACH OF WARRANTY, OR OTHERWISE.
+ *
+ **************************************************************************/
+
+#ifndef __FRONTEND_H
+#define __FRONTEND_H
+
+#include "TCPIP Stack/TCPIP.h"
+
+/*****************************************************************************
+	Requests from the application tasks to the TCP/IP task.
+	A library function gets a free request descriptor with FrontEndLock, 
+	fills its parameters, runs the callback FP[cmd] inside the TCP/IP task 
+	with FrontEndCall, reads the results and gives the descriptor back with 
+	FrontEndUnlock. The calling task sleeps while it waits, and up to 
+	FRONTEND_SLOTS requests from different tasks can be in flight.
+*****************************************************************************/
+
+#define FRONTEND_SLOTS		3	//	Requests in flight at the same time
+
+//	Max time for the TCP/IP task to pick up a command, then it's cancelled
+#define FRONTEND_TIMEOUT	(10000 / portTICK_RATE_MS)
+
+#define FRONTEND_CMDS		48	//	Size of the callback table FP[]
+
+//	Uncomment to collect latency histograms of the requests, see FrontEndStats
+//#define FRONTEND_STATS
+#define FRONTEND_BUCKETS	10	//	Buckets of the histograms: 0, 1, 2-3, 4-7... ticks
+
+//	Histograms kept for each FP[] index
+#define FE_HIST_WAIT		0	//	Time spent in the queue before the TCP/IP task picked up the request
+#define FE_HIST_EXEC		1	//	Execution time of the callback
+#define FE_HIST_CALL		2	//	Time the calling task slept in FrontEndCall
+
+typedef struct
+{
+	//	Parameters
+	BYTE sock;				//	TCP_SOCKET or UDP socket number
+	BYTE *data;				//	Buffer to read into or to write from
+	char *str;				//	String parameter: host, address, SMTP field...
+	int len;				//	Length of data, or generic integer parameter
+	int start;				//	Start offset for TCPpRead
+	BYTE type;				//	Socket or connection type
+	BYTE remhost;			//	Remote host type for TCPGenericOpen
+	WORD port;				//	Local port
+	WORD remport;			//	Remote port
+	DWORD remaddr;			//	Remote host for UDPGenericOpen
+	
+	//	Results
+	WORD res;				//	Value returned by the stack: socket, length, status...
+	void *out;				//	Where the callback copies larger results
+	
+	//	Internal use
+	int cmd;				//	Index of the callback in FP[]
+	BYTE stat;
+	xSemaphoreHandle done;
+	#if defined (FRONTEND_STATS)
+	portTickType tqueued;	//	When the request was queued
+	portTickType trun;		//	When the callback was started
+	#endif
+} FRONTEND_REQ;
+
+BOOL FrontEndInit();
+FRONTEND_REQ* FrontEndLock();
+int FrontEndCall(FRONTEND_REQ*, int);
+void FrontEndUnlock(FRONTEND_REQ*);
+void FrontEndAbort();
+
+void StackLock();
+void StackUnlock();
+portTickType StackLockMaxHold(BOOL);
+
+#if defined (FRONTEND_STATS)
+WORD* FrontEndStats(int, int);
+void FrontEndStatsReset();
+void FrontEndStatsDump(int);
+#endif
+
+#endif
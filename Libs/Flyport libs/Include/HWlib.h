@@ -71,6 +71,20 @@
 #define UART_BUFFER_SIZE_3 	256
 #define UART_BUFFER_SIZE_4 	256
 
+//	UART TX ring, drained by the TX interrupt
+#define UART_TX_BUFFER_SIZE_1 	256
+#define UART_TX_BUFFER_SIZE_2 	128
+#define UART_TX_BUFFER_SIZE_3 	128
+#define UART_TX_BUFFER_SIZE_4 	128
+
+//	What UARTWrite does when the string doesn't fit in the TX ring, strings 
+//	longer than the ring are queued in pieces and each piece follows the policy
+#define UART_TX_DROP		0	// the piece and the rest of the string are discarded
+#define UART_TX_BLOCK		1	// the task sleeps until there is room, up to the timeout
+#define UART_TX_TRUNCATE	2	// the part that fits is sent, the rest is discarded
+#define UART_TX_DEF_POLICY	UART_TX_BLOCK
+#define UART_TX_DEF_TIMEOUT	portMAX_DELAY	// RTOS ticks for UART_TX_BLOCK, portMAX_DELAY waits forever
+
 
 //	WiFi Status defs
 #define NOT_CONNECTED		0
@@ -213,6 +227,10 @@ int UARTBufferSize(int port);
 void UARTWrite(int port, char *buffer); 
 int UARTRead (int , char* , int);
 void UARTWriteCh(int , char);
+void UARTTxInt(int port);
+void UARTTxPolicy(int port, BYTE policy, portTickType timeout);
+unsigned int UARTTxDropped(int port, BOOL reset);
+void UARTTxDrain(int port);
 //static
 BOOL DownloadMPFS(void);
 void _dbgwrite(char* dbgstr);
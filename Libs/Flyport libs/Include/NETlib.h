@@ -52,6 +52,7 @@
 #define __NET_LIB_H
 #include "HWmap.h"
 #include "GenericTypeDefs.h"
+#include "FrontEnd.h"
 void NETCustomSave();
 void NETCustomDelete();
 void NETCustomLoad();
@@ -72,7 +73,7 @@ void NETSetParam(int , char []);
 
 #if defined (FLYPORT_ETH)
 void ETHRestart(int);
-int cETHRestart();
+int cETHRestart(FRONTEND_REQ*);
 #endif
 
 
@@ -132,31 +133,31 @@ typedef struct
 void WFGeneric(int); 
 
 void WFConnect(int);
-int cWFConnect();
+int cWFConnect(FRONTEND_REQ*);
 
 void WFScan();
-int cWFScan();
+int cWFScan(FRONTEND_REQ*);
 
 #ifdef FLYPORT_G
 void RSSIUpdate();
-int cRSSIUpdate();
+int cRSSIUpdate(FRONTEND_REQ*);
 int RSSIValue();
 BYTE RSSIStatus();
 BOOL WFGetPSK(char *myPsk);
-int cWFGetPSK();
+int cWFGetPSK(FRONTEND_REQ*);
 #endif
 
 void WFDisconnect();
-int cWFDisconnect();
+int cWFDisconnect(FRONTEND_REQ*);
 
 void WFSetChannel(unsigned int chSets);
 void WFSetSecurity(BYTE , char* , BYTE , BYTE);
 
 void WFStopConnecting();
-int cWFStopConnecting();
+int cWFStopConnecting(FRONTEND_REQ*);
 
 tWFNetwork WFScanList(int);
-int cWFScanList();
+int cWFScanList(FRONTEND_REQ*);
 
 void WFHibernate();
 void WFSleep();
@@ -164,8 +165,8 @@ void WFOn();
 
 
 void WFPsPollEnable(BOOL ps_active);
-int cWFPsPollDisable();
-int cWFPsPollEnable();
+int cWFPsPollDisable(FRONTEND_REQ*);
+int cWFPsPollEnable(FRONTEND_REQ*);
 
 int WFGetStat();
 #endif
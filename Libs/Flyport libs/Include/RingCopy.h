@@ -0,0 +1,70 @@
+/* **************************************************************************																					
+ *                                OpenPicus                 www.openpicus.com
+ *                                                            italian concept
+ * 
+ *            openSource wireless Platform for sensors and Internet of Things	
+ * **************************************************************************
+ *  FileName:        RingCopy.h
+ *  Dependencies:    none
+ *  Module:          FlyPort WI-FI
+ *  Compiler:        Microchip C30 v3.12 or higher
+ *
+ *  Software License Agreement
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  This is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License (version 2) as published by 
+ *  the Free Software Foundation AND MODIFIED BY OpenPicus team.
+ *  
+ *  ***NOTE*** The exception to the GPL is included to allow you to distribute
+ *  a combined work that includes OpenPicus code without being obliged to 
+ *  provide the source code for proprietary components outside of the OpenPicus
+ *  code. 
+ *  OpenPicus software is distributed in the hope that it will be useful, but 
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ *  more details. 
+ * 
+ * 
+ * Warranty
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * THE SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT
+ * WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTY OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * WE ARE LIABLE FOR ANY INCIDENTAL, SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF
+ * PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY OR SERVICES, ANY CLAIMS
+ * BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE
+ * THEREOF), ANY CLAIMS FOR INDEMNITY OR CONTRIBUTION, OR OTHER
+ * SIMILAR COSTS, WHETHER ASSERTED ON THE BASIS OF CONTRACT, TORT
+ * (INCLUDING NEGLIGENCE), BREACH OF WARRANTY, OR OTHERWISE.
+ *
+ **************************************************************************/
+
+#ifndef __RINGCOPY_H
+#define __RINGCOPY_H
+
+#include <string.h>
+
+/*****************************************************************************
+	Copy out of a ring buffer, used by UARTRead. Plain C with no other 
+	dependency, so test/ring_read_bench.c measures this same code on a PC.
+*****************************************************************************/
+
+//	Copies count bytes starting at pos, in at most two memcpy: the part up 
+//	to the end of the ring and the part at its start. count must not exceed 
+//	size. Returns the position following the last byte copied.
+static int RingRead(char *dst, const char *ring, int size, int pos, int count)
+{
+	int first = size - pos;
+	if (first > count)
+		first = count;
+	memcpy(dst, ring+pos, first);
+	if (count > first)
+		memcpy(dst+first, ring, count-first);
+	if (pos + count >= size)
+		return pos + count - size;
+	return pos + count;
+}
+
+#endif
@@ -50,33 +50,23 @@
 
 // TCPIP stack includes
 #include "TCPIP Stack/TCPIP.h"
+#include "FrontEnd.h"
 #include "TCPIP Stack/SMTP.h"
 
 
 //	Frontend variables
 extern BYTE xIPAddress[];
-extern WORD xTCPPort;
-extern TCP_SOCKET xSocket;
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
-extern BOOL xBool;
-extern WORD xWord;
-extern char *xChar;
-extern BYTE *xByte;
-extern BYTE xByte2;
-extern BYTE xByte3;
-extern int xInt;
 extern SMTP_POINTERS SMTPClient;
 
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 
 #if defined(STACK_USE_SMTP_CLIENT)
  BOOL SMTPStart();
- int cSMTPStart();
+ int cSMTPStart(FRONTEND_REQ*);
 #endif
 
 #define SERVER_NAME		0
@@ -92,23 +82,23 @@ extern xSemaphoreHandle xSemFrontEnd;
 #define	MSG_BODY		5
 
 void SMTPSetServer(int , char *);
-int cSMTPSetServer();
+int cSMTPSetServer(FRONTEND_REQ*);
 
 void SMTPSetMsg(int , char *);
-int cSMTPSetMsg();
+int cSMTPSetMsg(FRONTEND_REQ*);
 
 BOOL GenericSMTP(int);
 
 BOOL SMTPSend();
-int cSMTPSend();
+int cSMTPSend(FRONTEND_REQ*);
 
 BOOL SMTPBusy();
-int cSMTPBusy();
+int cSMTPBusy(FRONTEND_REQ*);
 
 BOOL SMTPStop();
-int cSMTPStop();
+int cSMTPStop(FRONTEND_REQ*);
 
 WORD SMTPReport();
-int cSMTPReport();
+int cSMTPReport(FRONTEND_REQ*);
 
 #endif
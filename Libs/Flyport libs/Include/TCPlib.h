@@ -52,35 +52,66 @@
 // TCPIP stack includes
 //#include "WF_Config.h"
 #include "TCPIP Stack/TCPIP.h"
-
+#include "FrontEnd.h"
+
+
+#define TCP_WRITEV 33
+#define TCP_READMAX 39
+#define TCP_BATCH 40
+#define TCP_FLUSH 41
+#define TCP_RING_ON 42
+#define TCP_RING_OFF 43
+#define TCP_RX_WAITERS 2	//	Tasks that can wait at the same time in TCPRxWait
+#define TCP_RX_RINGS 2		//	Sockets that can have an RX ring at the same time, see TCPRxRingOn
+#define TCP_SNAP_SOCKETS TCP_CONFIGURED_SOCKETS	//	Sockets in the state snapshot, one for each entry of TCPSocketInitializer
+
+//	State of a socket published by the TCP/IP task, see TCPSnapUpdate
+typedef struct
+{
+	BOOL conn;				//	Connected
+	WORD rxlen;				//	Bytes that can be read
+	WORD txfree;			//	Free space in the TX buffer
+} TCP_SNAP;
+
+//	Element of the list of arrays written by TCPWriteV
+typedef struct
+{
+	char* data;
+	int len;
+} TCP_IOVEC;
+
+//	Operations of the list executed by TCPBatch
+#define TCP_OP_PUT		0	//	Puts len bytes of data in the TX buffer, without flushing
+#define TCP_OP_FLUSH	1	//	Flushes the TX buffer
+#define TCP_OP_READ		2	//	Reads up to len bytes in data, NULL terminated
+#define TCP_OP_RXLEN	3	//	Number of bytes that can be read
+#define TCP_OP_RXFLUSH	4	//	Discards the RX buffer
+#define TCP_OP_ISCONN	5	//	TRUE if the socket is connected
+
+//	Element of the list of operations executed by TCPBatch
+typedef struct
+{
+	BYTE op;
+	TCP_SOCKET sock;
+	char* data;
+	int len;
+	WORD res;				//	Bytes put or read, RX length, connection status
+} TCP_OP;
 
 //	Frontend variables
 extern BYTE xIPAddress[];
-extern WORD xTCPPort;
-extern TCP_SOCKET xSocket;
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
-extern BOOL xBool;
-extern WORD xWord;
-extern char *xChar;
-extern BYTE *xByte;
-extern BYTE xByte2;
-extern BYTE xByte3;
-extern int xInt;
-extern int xInt2;
-extern NODE_INFO xNode;
 
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 
 
 /*****************************************************************************
 	TCP function declarations	
 *****************************************************************************/
-int cTCPGenericOpen();
+int cTCPGenericOpen(FRONTEND_REQ*);
 TCP_SOCKET TCPGenericOpen(char* , BYTE , char* , BYTE);
 
 TCP_SOCKET TCPClientOpen (char* , char*);
@@ -89,37 +120,63 @@ TCP_SOCKET TCPServerOpen (char*);
 void TCPClientClose(TCP_SOCKET);
 void TCPServerClose(TCP_SOCKET);
 
-int cTCPisConn();
+int cTCPisConn(FRONTEND_REQ*);
 BOOL TCPisConn(TCP_SOCKET);
 
-int cTCPWrite();
+int cTCPWrite(FRONTEND_REQ*);
 WORD TCPWrite(TCP_SOCKET , char* , int);
 
-int cTCPGenericClose();
+int cTCPWriteV(FRONTEND_REQ*);
+WORD TCPWriteV(TCP_SOCKET , TCP_IOVEC* , int);
+
+void TCPCork(TCP_SOCKET , BOOL);
+int cTCPFlushNow(FRONTEND_REQ*);
+void TCPFlushNow(TCP_SOCKET);
+
+int cTCPGenericClose(FRONTEND_REQ*);
 void TCPGenericClose(TCP_SOCKET);
 
-int cTCPRxLen();
+int cTCPRxLen(FRONTEND_REQ*);
 WORD TCPRxLen(TCP_SOCKET);
 
-int cTCPRxFlush();
+WORD TCPTxFree(TCP_SOCKET);
+
+WORD TCPRxWait(TCP_SOCKET, WORD, portTickType);
+void TCPRxWaitInit();
+void TCPRxWaitCheck();
+void TCPSnapUpdate();
+
+BOOL TCPRxRingOn(TCP_SOCKET, BYTE*, WORD);
+int cTCPRxRingOn(FRONTEND_REQ*);
+void TCPRxRingOff(TCP_SOCKET);
+int cTCPRxRingOff(FRONTEND_REQ*);
+void TCPRxRingFill();
+
+int cTCPRxFlush(FRONTEND_REQ*);
 void TCPRxFlush(TCP_SOCKET);
 
-int cTCPRead();
+int cTCPRead(FRONTEND_REQ*);
 void TCPRead(TCP_SOCKET, char*, int);
 
-int cTCPpRead();
+int cTCPpRead(FRONTEND_REQ*);
 void TCPpRead(TCP_SOCKET, char*, int, int);
 
+int cTCPReadMax(FRONTEND_REQ*);
+WORD TCPReadMax(TCP_SOCKET, char*, int);
+
+int cTCPBatch(FRONTEND_REQ*);
+int TCPBatch(TCP_OP*, int);
+
 void TCPServerDetach(TCP_SOCKET);
-int cTCPServerDetach();
+int cTCPServerDetach(FRONTEND_REQ*);
 
 NODE_INFO TCPRemote(TCP_SOCKET);
-int cTCPRemote();
+int cTCPRemote(FRONTEND_REQ*);
 #if defined (STACK_USE_SSL_CLIENT)
 BYTE TCPSSLStart(TCP_SOCKET sslsock);
-int cTCPSSLStart();
+int cTCPSSLStart(FRONTEND_REQ*);
 
 BYTE TCPSSLStatus(TCP_SOCKET sslclient);
-int cTCPSSLStatus();
+int cTCPSSLStatus(FRONTEND_REQ*);
 #endif
 #endif
@@ -55,6 +55,7 @@
 #include "ARPlib.h"
 
 #define MAX_UDP_SOCKETS_FREERTOS (1u)
+#define UDP_WRITEV 44
 
 #define BUFFER_UDP_FIXED_LEN 50
 #define BUFFER1_UDP_LEN 200
@@ -62,6 +63,28 @@
 #define BUFFER3_UDP_LEN BUFFER_UDP_FIXED_LEN
 #define BUFFER4_UDP_LEN BUFFER_UDP_FIXED_LEN
 
+//	What is dropped when a datagram doesn't fit in the RX buffer
+#define UDP_DROP_NEWEST 0
+#define UDP_DROP_OLDEST 1
+
+//	Header stored in the RX buffer before the data of each datagram
+typedef struct
+{
+	WORD len;
+	WORD remport;
+	DWORD remhost;
+} UDP_DGRAM_HDR;
+
+//	Element of the list of datagrams sent by UDPWriteV
+typedef struct
+{
+	BYTE* data;
+	int len;
+	NODE_INFO* remnode;		//	Receiver, NULL to use the one of the socket
+	WORD remport;			//	Port of the receiver, used only with remnode
+	WORD res;				//	Bytes sent
+} UDP_DGRAM;
+
 //UDP variables:
 extern WORD BUFFER_UDP_LEN[MAX_UDP_SOCKETS_FREERTOS];
 extern BYTE* udpBuffer[MAX_UDP_SOCKETS_FREERTOS];
@@ -69,30 +92,18 @@ extern WORD udpRxLenGlobal[MAX_UDP_SOCKETS_FREERTOS];
 extern BYTE numUdpSocket;
 extern UDP_SOCKET udpSocket[MAX_UDP_SOCKETS_FREERTOS];
 extern UDP_PORT xUDPPort[MAX_UDP_SOCKETS_FREERTOS];
-extern BYTE callbackUdpSocket;
-extern 	BYTE* p_udp_data[MAX_UDP_SOCKETS_FREERTOS];
-extern 	BYTE* p_udp_wifiram[MAX_UDP_SOCKETS_FREERTOS];
-extern DWORD xUDPRemoteHost;
-extern WORD xUDPLocalPort;
-extern WORD xUDPRemotePort;
-extern WORD udpWord;
-extern int udpInt;
-extern BYTE* udpByte;
 
 
 extern int udpFrontEndStat;
 extern int udpFrontEndStatRet;
 extern BOOL udpBool;
 extern BOOL UDPoverflowFlag[MAX_UDP_SOCKETS_FREERTOS];
-extern BYTE xByte2;
 //	Frontend variables
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 
 BYTE UDPClientOpen (char udpaddr[], char udpport[]);
 BYTE UDPServerOpen (char udpport[]);
@@ -102,7 +113,10 @@ BYTE UDPClientClose(BYTE sock);
 BYTE UDPServerClose(BYTE sock);
 
 WORD UDPWrite(BYTE , BYTE* , int);
-int cUDPWrite();
+int cUDPWrite(FRONTEND_REQ*);
+
+int UDPWriteV(BYTE , UDP_DGRAM* , int);
+int cUDPWriteV(FRONTEND_REQ*);
 
 WORD UDPLocalPort(BYTE);
 
@@ -111,17 +125,24 @@ void UDPRxFlush(BYTE sock);
 BOOL UDPRxOver(BYTE);
 int UDPRead(BYTE, char*, int);
 int UDPpRead(BYTE, char*, int, int);
+int UDPReadDatagram(BYTE, char*, int, DWORD*, WORD*);
+WORD UDPRxDatagrams(BYTE);
+WORD UDPRxDropped(BYTE, BOOL);
+void UDPRxPolicy(BYTE, BYTE);
 
 //internal use
 BYTE UDPGenericOpen(char localport[], DWORD remhost, char remoteport[], BYTE connType);
-int cUDPGenericOpen();
+int cUDPGenericOpen(FRONTEND_REQ*);
 
 BYTE UDPGenericClose(BYTE);
-int cUDPGenericClose();
+int cUDPGenericClose(FRONTEND_REQ*);
 
 void UDPMultiOn(char* multiaddres);
-int cUDPMultiOn();
+int cUDPMultiOn(FRONTEND_REQ*);
 
 BYTE UDPMultiOpen(char *udpmultiaddr, char udpmultiport[]);
 
+void UDPRxFill();
+void UDPRxReset(BYTE);
+
 #endif // #ifndef __UDPLIB_H
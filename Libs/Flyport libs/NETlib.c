@@ -79,6 +79,7 @@ The Flyport modules have two possible profile to use: a DEFAULT one (fixed in fi
 #include "TCPIP Stack/TCPIP.h"
 #include "NETlib.h"
 #include "taskTCPIP.h"
+#include "FrontEnd.h"
 
 #include "libpic30.h"
 
@@ -90,65 +91,34 @@ extern RSSI_VAL myRSSI;
 /// @cond debug
 //	Frontend variables
 extern BYTE xIPAddress[];
-extern WORD xTCPPort;
-extern TCP_SOCKET xSocket;
 extern int xFrontEndStat;
-extern int xFrontEndStatRet;
 extern int xErr;
-extern BOOL xBool;
-extern WORD xWord;
-extern char *xChar;
-extern BYTE *xByte;
-extern BYTE xByte2;
-extern BYTE xByte3;
-extern int xInt;
-extern NODE_INFO xNode;
 
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 extern xTaskHandle hTCPIPTask;
-static int ToSend = 0; 
 /// @endcond
 
 #if defined (FLYPORT_G)
 BOOL WFGetPSK(char *myPsk)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	WORD resBool;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->str = myPsk;
+	if (FrontEndCall(req, 9) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 9;
-			xFrontEndStatRet = 2;
-			xChar = myPsk;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPRxLen request to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return 0;
-		}
+		FrontEndUnlock(req);
+		return 0;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	WORD resBool;
-	resBool = xBool;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	//taskYIELD();
+	resBool = req->res;
+	FrontEndUnlock(req);
 	return resBool;
 }
 
-int cWFGetPSK()
+int cWFGetPSK(FRONTEND_REQ* req)
 {
 	tWFCPElements profile;
 	UINT8 connState;
@@ -157,11 +127,11 @@ int cWFGetPSK()
 	WF_CPGetElements(connID, &profile);
 	if ((profile.securityType < 3) || (profile.securityKeyLength != 32))
 	{
-		xBool = FALSE;
+		req->res = FALSE;
 		return 0;
 	}
-	memcpy(xChar, profile.securityKey, 32);
-	xBool = TRUE;
+	memcpy(req->str, profile.securityKey, 32);
+	req->res = TRUE;
 	int a;
 	a=0;
 	a++;
@@ -407,40 +377,20 @@ void NETSetParam(int paramtoset , char paramstring[])
  */
 void ETHRestart(int ethprofile)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 1;
-			xFrontEndStatRet = 2;
-			xInt = ethprofile;
-			xQueueSendToBack(xQueue,&ToSend,0);						//	Send function code command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE		
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-		}
-	}
-
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->len = ethprofile;
+	FrontEndCall(req, 1);										//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 
 /// @cond debug
-int cETHRestart()
+int cETHRestart(FRONTEND_REQ* req)
 {
-	AppConfig = NETConf[xInt];
+	AppConfig = NETConf[req->len];
 	MACInit();
 	return 0;
 }
@@ -453,7 +403,6 @@ int cETHRestart()
  ****************************************************/
 #if defined (FLYPORT_WF)
 
-extern tWFNetwork xNet;
 extern int WFStatusold;
 
 
@@ -462,36 +411,12 @@ extern void	WF_Connect(int);
 
 void WFGeneric(int function)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = function;
-			xFrontEndStatRet = 2;
-
-			xQueueSendToBack(xQueue,&ToSend,0);						//	Send function code command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE		
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
-	}
-
-	while (xFrontEndStat != 2);                                     //	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);					//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	FrontEndCall(req, function);								//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 /// @endcond
 
@@ -504,45 +429,14 @@ void WFGeneric(int function)
  */
 void WFConnect(int pconn)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			//	OpCode and requested return value from the stack
-			ToSend = 1;
-			xFrontEndStatRet = 2;
-			
-			//	Passing function parameter
-			xInt = pconn;										//	Connection profile to use
-			
-			//	Queue and status setting, callback is ready to be fired when semaphore is released
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send requested command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-			{
-				return;
-			}
-		}
-	}
-
-	while (xFrontEndStat != 2);							//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;									//	TCP/IP stack newly ready to accept commands
-	xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	//	Passing function parameter
+	req->len = pconn;											//	Connection profile to use
+	FrontEndCall(req, 1);										//	Waits for stack answer
+	FrontEndUnlock(req);										//	TCP/IP stack newly ready to accept commands
 }
 
 
@@ -595,7 +489,7 @@ void RSSIUpdate()
 }
 
 
-int cRSSIUpdate()
+int cRSSIUpdate(FRONTEND_REQ* req)
 {
 	BYTE oldChannlList[11], chanLen, oldBSSID[6];
 	if (AppConfig.networkType == WF_INFRASTRUCTURE)
@@ -655,43 +549,20 @@ BYTE RSSIStatus()
  */
 tWFNetwork WFScanList(int ntscn)
 {
+	tWFNetwork netret;
+	memset(&netret, 0, sizeof(netret));
 	if (WFNetworkFound != 0)
 	{
-		BOOL opok = FALSE;
-		while (!opok)
-		{
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-			if (xFrontEndStat == 0)
-			{	
-				ToSend = 7;
-				xInt = ntscn-1;
-				xFrontEndStatRet = 2;
-				xQueueSendToBack(xQueue,&ToSend,0);						//	Send WFScanList command to the stack
-				xFrontEndStat = 1;
-				xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE	
-				opok = TRUE;
-			}
-			else
-			{
-				xSemaphoreGive(xSemFrontEnd);
-				taskYIELD();
-				//	If WiFi module if turned OFF, function doesn't do anything
-				if (xFrontEndStat == -1)
-					return xNet;
-			}
-		}
-		
-		while (xFrontEndStat != 2);								//	Waits for stack answer
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		
-		tWFNetwork netret;
-		xFrontEndStat = 0;
-		netret = xNet;
-		xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-		taskYIELD();
-		return netret;
+		FRONTEND_REQ* req = FrontEndLock();
+		//	If WiFi module if turned OFF, function doesn't do anything
+		if (req == NULL)
+			return netret;
+		req->len = ntscn-1;
+		req->out = &netret;
+		FrontEndCall(req, 7);								//	Waits for stack answer
+		FrontEndUnlock(req);
 	}
-	return xNet;
+	return netret;
 }
 
 
@@ -704,46 +575,12 @@ tWFNetwork WFScanList(int ntscn)
  */
 void WFStopConnecting()
 {
-	/*
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	if ( (_WFStat == CONNECTING) || (_WFStat == CONNECTION_LOST) || (_WFStat == CONNECTION_FAILED))
-	{
-	*/
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-
-		if (xFrontEndStat == 0)
-		{	
-			//	OpCode and requested return value from the stack
-			ToSend = 10;
-			xFrontEndStatRet = 2;
-			
-			//	Queue and status setting, callback is ready to be fired when semaphore is released
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
-	}
-
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;										//	TCP/IP stack newly ready to accept commands
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	FrontEndCall(req, 10);										//	Waits for stack answer
+	FrontEndUnlock(req);										//	TCP/IP stack newly ready to accept commands
 }
 
 
@@ -814,9 +651,12 @@ void WFHibernate()
 	_WFStat = TURNED_OFF;
 	if (hTCPIPTask != NULL)
 	{
+		StackLock();					// TCP task out of the stack
 		WF_HIBERNATE_IO = 1;				// Wi-Fi module hibernation
         WF_SetRST_N(WF_LOW);            // put module into reset
 		vTaskDelete(hTCPIPTask);		// TCP task delete
+		FrontEndAbort();				// wakes up the tasks waiting for the deleted task
+		StackUnlock();
 		vTaskDelay(5);
 		hTCPIPTask = NULL;
 	}
@@ -835,9 +675,12 @@ void WFSleep()
 	_WFStat = TURNED_OFF;
 	if (hTCPIPTask != NULL)
 	{
+		StackLock();					// TCP task out of the stack
 		WF_HIBERNATE_IO = 1;				// Wi-Fi module hibernation
 		WF_SetRST_N(WF_LOW);            // put module into reset
 		vTaskDelete(hTCPIPTask);		// TCP task delete
+		FrontEndAbort();				// wakes up the tasks waiting for the deleted task
+		StackUnlock();
 		vTaskDelay(5);
 		hTCPIPTask = NULL;
 	}
@@ -880,44 +723,21 @@ void WFOn()
  */
 void WFPsPollEnable(BOOL ps_active)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	if (ps_active)
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			if (ps_active)
-				ToSend = 6; //cWFPsPollEnable
-			else
-				ToSend = 5; //cWFPsPollDisable
-			xFrontEndStatRet = 2;
-
-			xQueueSendToBack(xQueue,&ToSend,0);						//	Send function code command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			if (ps_active)
-				xErr = 6; //cWFPsPollEnable
-			else
-				xErr = 5; //cWFPsPollDisable
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
+		if (FrontEndCall(req, 6) != 0)	//cWFPsPollEnable
+			xErr = 6;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	else
+	{
+		if (FrontEndCall(req, 5) != 0)	//cWFPsPollDisable
+			xErr = 5;
+	}
+	FrontEndUnlock(req);
 }
 
 /// @cond debug
@@ -925,7 +745,7 @@ void WFPsPollEnable(BOOL ps_active)
 //	Only internal use:
 //	WFDisconnect callback function
 //****************************************************************************
-int cWFDisconnect()
+int cWFDisconnect(FRONTEND_REQ* req)
 {
 	if (_WFStat == CONNECTED)
 	{
@@ -942,7 +762,7 @@ int cWFDisconnect()
 //	Only internal use:
 //	WFScan callback function
 //****************************************************************************
-int cWFScan()
+int cWFScan(FRONTEND_REQ* req)
 {
 #if defined FLYPORT_G
 	if ((AppConfig.networkType == WF_SOFT_AP) && (_WFStat == CONNECTED))
@@ -987,47 +807,48 @@ int cWFScan()
 //	Only internal use:
 //	WFScanList callback function
 //****************************************************************************
-int cWFScanList()
+int cWFScanList(FRONTEND_REQ* req)
 {
 
 	int x1;
 	tWFScanResult  Sc1out;	
-	WF_ScanGetResult(xInt,&Sc1out);
+	tWFNetwork* net = (tWFNetwork*) req->out;
+	WF_ScanGetResult(req->len,&Sc1out);
 
 	//	SSID of the network
 
 	for (x1 = 0 ; x1 < Sc1out.ssidLen ; x1++)
-		xNet.ssid[x1] = (char)Sc1out.ssid[x1];
-	xNet.ssid[Sc1out.ssidLen] = '\0';
+		net->ssid[x1] = (char)Sc1out.ssid[x1];
+	net->ssid[Sc1out.ssidLen] = '\0';
 	
 	// Type of the network (WF_INFRASTRUCTURE or WF_ADHOC)
-	xNet.type = Sc1out.bssType;
+	net->type = Sc1out.bssType;
 	
 	// Signal strength
-	xNet.signal = Sc1out.rssi;
+	net->signal = Sc1out.rssi;
 	
 	// Channel
-	xNet.channel = Sc1out.channel;
+	net->channel = Sc1out.channel;
 	
 	// Beacon period
-	xNet.beacon = Sc1out.beaconPeriod;
+	net->beacon = Sc1out.beaconPeriod;
 	
 	// BSSID
 	for (x1 = 0 ; x1 < WF_BSSID_LENGTH ; x1++)
-		xNet.bssid[x1] = (char)Sc1out.bssid[x1];
+		net->bssid[x1] = (char)Sc1out.bssid[x1];
 		
 	// Security
 	if ( (Sc1out.apConfig & 16) == 0)
-		xNet.security = WF_SECURITY_OPEN;
+		net->security = WF_SECURITY_OPEN;
 	else
 	{
 		if ( (Sc1out.apConfig & 128) != 0)
-			xNet.security = WF_SECURITY_GENERIC_WPA2;	
+			net->security = WF_SECURITY_GENERIC_WPA2;	
 		else 
 			if ( (Sc1out.apConfig & 64) != 0)
-				xNet.security = WF_SECURITY_GENERIC_WPA; 
+				net->security = WF_SECURITY_GENERIC_WPA; 
 			else
-				xNet.security = WF_SECURITY_GENERIC_WEP; 	
+				net->security = WF_SECURITY_GENERIC_WEP; 	
 	}
 
 	return 0;
@@ -1043,7 +864,7 @@ int WFGetStat()
 //	Only internal use:
 //	WFStopConnecting callback function
 //****************************************************************************
-int cWFStopConnecting()
+int cWFStopConnecting(FRONTEND_REQ* req)
 {
 	if (_WFStat == CONNECTING) 
 	{
@@ -1063,10 +884,10 @@ int cWFStopConnecting()
 //	Only internal use:
 //	WFConnect callback function
 //****************************************************************************
-int cWFConnect()
+int cWFConnect(FRONTEND_REQ* req)
 {
 	if (_WFStat == NOT_CONNECTED)
-		WF_Connect(xInt);
+		WF_Connect(req->len);
 	return 0;
 }
 
@@ -1075,7 +896,7 @@ int cWFConnect()
 //	Only internal use:
 //	WFPsPollDisable callback function
 //****************************************************************************
-int cWFPsPollDisable()
+int cWFPsPollDisable(FRONTEND_REQ* req)
 {
 	WF_PsPollDisable();
 	return 0;
@@ -1084,7 +905,7 @@ int cWFPsPollDisable()
 //	Only internal use:
 //	WFPsPollEnable callback function
 //****************************************************************************
-int cWFPsPollEnable()
+int cWFPsPollEnable(FRONTEND_REQ* req)
 {
 	WF_PsPollEnable(TRUE);
 	return 0;
@@ -66,7 +66,6 @@ The SMTP commands allows to set the parameters for the SMTP connection, and to s
 
 
 
-static int ToSend = 0; 
 
 #if defined(STACK_USE_SMTP_CLIENT)
  /// @cond debug
@@ -75,38 +74,18 @@ static int ToSend = 0;
 //****************************************************************************
 BOOL GenericSMTP(int fSMTP)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	BOOL retBool;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return FALSE;
+	if (FrontEndCall(req, fSMTP) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = fSMTP;
-			xFrontEndStatRet = 2;
-			
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPIsConnected command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE		
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return FALSE;
-		}	
+		FrontEndUnlock(req);
+		return FALSE;
 	}
-
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	BOOL retBool;
-	retBool = xBool;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	retBool = (BOOL) req->res;
+	FrontEndUnlock(req);
 	return retBool;
 }
  /// @endcond
@@ -125,9 +104,9 @@ BOOL GenericSMTP(int fSMTP)
  }
  
  /// @cond debug
- int cSMTPStart()
+ int cSMTPStart(FRONTEND_REQ* req)
  {
-	xBool = SMTPBeginUsage();
+	req->res = SMTPBeginUsage();
 	return 0;
  }
  /// @endcond
@@ -149,61 +128,39 @@ BOOL GenericSMTP(int fSMTP)
  */
 void SMTPSetServer(int servparam , char * paramfield)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 27;
-			xFrontEndStatRet = 2;
-			xInt = servparam;
-			xChar = paramfield;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPIsConnected command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}	
-	}
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->len = servparam;
+	req->str = paramfield;
+	FrontEndCall(req, 27);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
  /// @cond debug
-int cSMTPSetServer()
+int cSMTPSetServer(FRONTEND_REQ* req)
 {
-	switch (xInt)
+	switch (req->len)
 	{
 	//	Setting server name
 	case SERVER_NAME:
-		SMTPClient.Server.szRAM = (BYTE *) xChar;
+		SMTPClient.Server.szRAM = (BYTE *) req->str;
 		break;
 	
 	//	Setting username
 	case SERVER_USER:
-		SMTPClient.Username.szRAM = (BYTE *) xChar;
+		SMTPClient.Username.szRAM = (BYTE *) req->str;
 		break;
 		
 	//	Setting password
 	case SERVER_PASS:
-		SMTPClient.Password.szRAM = (BYTE *) xChar;
+		SMTPClient.Password.szRAM = (BYTE *) req->str;
 		break;
 		
 	//	Port setting
 	case SERVER_PORT:
-		SMTPClient.ServerPort = (WORD)atol(xChar);
+		SMTPClient.ServerPort = (WORD)atol(req->str);
 		break;		
 	}
 	return 0;
@@ -228,73 +185,50 @@ int cSMTPSetServer()
  */
 void SMTPSetMsg(int msgparam , char * mparamfield)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 28;
-			xFrontEndStatRet = 2;
-			xInt = msgparam;
-			xChar = mparamfield;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPIsConnected command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}	
-	}
-
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->len = msgparam;
+	req->str = mparamfield;
+	FrontEndCall(req, 28);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 
  /// @cond debug
-int cSMTPSetMsg()
+int cSMTPSetMsg(FRONTEND_REQ* req)
 {
-	switch (xInt)
+	switch (req->len)
 	{
 	//	Setting destination email address
 	case MSG_TO:
-		SMTPClient.To.szRAM = (BYTE *) xChar;
+		SMTPClient.To.szRAM = (BYTE *) req->str;
 		break;
 		
 	//	Setting cc for the message
 	case MSG_CC:
-		SMTPClient.CC.szRAM = (BYTE *) xChar;
+		SMTPClient.CC.szRAM = (BYTE *) req->str;
 		break;
 	
 	//	Setting bcc for the message
 	case MSG_BCC:
-		SMTPClient.BCC.szRAM = (BYTE *) xChar;
+		SMTPClient.BCC.szRAM = (BYTE *) req->str;
 		break;
 	
 	//	Setting sender of the message
 	case MSG_FROM:
-		SMTPClient.From.szRAM = (BYTE *) xChar;
+		SMTPClient.From.szRAM = (BYTE *) req->str;
 		break;
 		
 	//	Setting subject of the message
 	case MSG_SUBJECT:
-		SMTPClient.Subject.szRAM = (BYTE *) xChar;
+		SMTPClient.Subject.szRAM = (BYTE *) req->str;
 		break;
 	
 	//	Setting the body of the message
 	case MSG_BODY:
-		SMTPClient.Body.szRAM = (BYTE *) xChar;
+		SMTPClient.Body.szRAM = (BYTE *) req->str;
 		break;
 	}
 	return 0;
@@ -319,10 +253,10 @@ BOOL SMTPSend()
 //	Only internal use
 //	SMTPSend callback function
 //**************************************************************************** 
-int cSMTPSend()
+int cSMTPSend(FRONTEND_REQ* req)
 {
 	SMTPSendMail();
-	xBool = TRUE;
+	req->res = TRUE;
 	return 0;
 }
  /// @endcond
@@ -344,9 +278,9 @@ BOOL SMTPBusy()
 //	Only internal use
 //	SMTPBusy callback funtion
 //****************************************************************************
-int cSMTPBusy()
+int cSMTPBusy(FRONTEND_REQ* req)
 {
-	xBool = SMTPIsBusy();
+	req->res = SMTPIsBusy();
 	return 0;
 }
  /// @endcond
@@ -362,12 +296,12 @@ BOOL SMTPStop()
 //	Only internal use
 //	SMTPStop callback function
 //****************************************************************************
-int cSMTPStop()
+int cSMTPStop(FRONTEND_REQ* req)
 {
 	if (SMTPEndUsage() == SMTP_SUCCESS)
-		xBool = TRUE;
+		req->res = TRUE;
 	else
-		xBool = FALSE;		
+		req->res = FALSE;		
 	return 0;
 }
  /// @endcond
@@ -380,38 +314,18 @@ int cSMTPStop()
  */
 WORD SMTPReport()
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	WORD retWord;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return FALSE;
+	if (FrontEndCall(req, 32) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 32;
-			xFrontEndStatRet = 2;
-			
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPIsConnected command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE		
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return FALSE;
-		}	
+		FrontEndUnlock(req);
+		return FALSE;
 	}
-
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-
-	WORD retWord;
-	retWord = xWord;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	retWord = req->res;
+	FrontEndUnlock(req);
 	return retWord;
 }
  
@@ -420,9 +334,9 @@ WORD SMTPReport()
 //	Only internal use
 //	SMTPReport callback function
 //****************************************************************************
-int cSMTPReport()
+int cSMTPReport(FRONTEND_REQ* req)
 {	
-	xWord = SMTPEndUsage();
+	req->res = SMTPEndUsage();
 	return 0 ;
 }
  /// @endcond
@@ -68,102 +68,165 @@ The TCP library contains all the command to manage the TCP sockets. If you need
 
 #include "TCPlib.h"
 
-static int ToSend = 0; 
+
+//	Tasks waiting for RX data, see TCPRxWait
+static struct
+{
+	TCP_SOCKET sock;
+	WORD minlen;
+	WORD ready;
+	BYTE state;
+	xSemaphoreHandle sem;
+} RxWaiters[TCP_RX_WAITERS];
+
+#define RXWAIT_FREE		0
+#define RXWAIT_WAITING	1
+#define RXWAIT_READY	2
+
+//	Socket states read by TCPisConn, TCPRxLen and TCPTxFree without a 
+//	request to the TCP/IP task. Single WORDs, so they are read atomically
+static TCP_SNAP TCPSnap[TCP_SNAP_SOCKETS];
+
+//	Sockets in corked mode, see TCPCork
+static BOOL TCPCorked[TCP_SNAP_SOCKETS];
+
+//	App-side RX rings, see TCPRxRingOn. Filled by the TCP/IP task (head), 
+//	emptied by the task reading the socket (tail)
+static struct
+{
+	TCP_SOCKET sock;		//	INVALID_SOCKET if the ring is not used
+	BYTE* buf;
+	WORD size;
+	WORD head;
+	WORD tail;
+} RxRings[TCP_RX_RINGS];
+
+//	Only internal use: ring of the socket, -1 if it has no ring
+static int _TCPRing(TCP_SOCKET sock)
+{
+	int i;
+	if (sock == INVALID_SOCKET)
+		return -1;
+	for (i = 0; i < TCP_RX_RINGS; i++)
+		if (RxRings[i].sock == sock)
+			return i;
+	return -1;
+}
+
+//	Only internal use: bytes in the ring of the socket
+static WORD _TCPRingLen(TCP_SOCKET sock)
+{
+	int i = _TCPRing(sock);
+	WORD head, tail;
+	if (i < 0)
+		return 0;
+	head = RxRings[i].head;
+	tail = RxRings[i].tail;
+	return (head >= tail) ? (head - tail) : (RxRings[i].size - tail + head);
+}
+
+//	Only internal use: copies len bytes from offset off of the ring, 
+//	in two pieces if they wrap around the end of the buffer
+static void _TCPRingCopy(int i, BYTE* dst, WORD off, WORD len)
+{
+	WORD pos = RxRings[i].tail + off, first;
+	if (pos >= RxRings[i].size)
+		pos -= RxRings[i].size;
+	first = RxRings[i].size - pos;
+	if (first > len)
+		first = len;
+	memcpy(dst, RxRings[i].buf + pos, first);
+	if (len > first)
+		memcpy(dst + first, RxRings[i].buf, len - first);
+}
+
+//	Only internal use: reads up to len bytes from the ring and NULL 
+//	terminates them, returns the number of bytes read
+static WORD _TCPRingRead(int i, BYTE* dst, int len)
+{
+	WORD avail = _TCPRingLen(RxRings[i].sock), tail;
+	if (len < 0)
+		len = 0;
+	if (avail > len)
+		avail = len;
+	_TCPRingCopy(i, dst, 0, avail);
+	dst[avail] = '\0';
+	tail = RxRings[i].tail + avail;
+	if (tail >= RxRings[i].size)
+		tail -= RxRings[i].size;
+	RxRings[i].tail = tail;
+	return avail;
+}
+
+//	Only internal use: takes the snapshot of a socket, in the TCP/IP task
+static void _TCPSnapSocket(TCP_SOCKET sock)
+{
+	if (sock >= TCP_SNAP_SOCKETS)
+		return;
+	TCPSnap[sock].conn = TCPIsConnected(sock);
+	TCPSnap[sock].rxlen = TCPIsGetReady(sock);
+	TCPSnap[sock].txfree = TCPIsPutReady(sock);
+}
 /// @cond debug
 
 #if defined (STACK_USE_SSL_CLIENT)
 BYTE TCPSSLStatus(TCP_SOCKET sslclient)
 {
-    BOOL opok = FALSE;
-    while (!opok)
+    BYTE sslStatus;
+    FRONTEND_REQ* req = FrontEndLock();
+    //	If WiFi module if turned OFF, function doesn't do anything
+    if (req == NULL)
+	return 1;
+    req->sock = sslclient;
+    if (FrontEndCall(req, 14) != 0)								//	Waits for stack answer
     {
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	if (xFrontEndStat == 0)
-	{
-	    ToSend = 14;
-	    xFrontEndStatRet = 2;
-	    xSocket = sslclient;
-	    xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPRxLen request to the stack
-	    xFrontEndStat = 1;
-	    xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-	    opok = TRUE;
-	}
-	else
-	{
-	    xSemaphoreGive(xSemFrontEnd);
-	    taskYIELD();
-	    //	If WiFi module if turned OFF, function doesn't do anything
-	    if (xFrontEndStat == -1)
-		return 1;
-	}
+	FrontEndUnlock(req);
+	return 1;
     }
-
-    while (xFrontEndStat != 2);								//	Waits for stack answer
-    while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-    BYTE sslStatus;
-    sslStatus = xByte2;
-    xFrontEndStat = 0;
-    xSemaphoreGive(xSemFrontEnd);
+    sslStatus = (BYTE) req->res;
+    FrontEndUnlock(req);
     return sslStatus;
 }
 
-int cTCPSSLStatus()
+int cTCPSSLStatus(FRONTEND_REQ* req)
 {
-    if (TCPSSLIsHandshaking(xSocket))
-		xByte2 = 1;
-    else if (TCPIsSSL(xSocket))
-		xByte2 = 2;
+    if (TCPSSLIsHandshaking(req->sock))
+		req->res = 1;
+    else if (TCPIsSSL(req->sock))
+		req->res = 2;
     else
-		xByte2 = 0;
+		req->res = 0;
     return 0;
 }
 
 BYTE TCPSSLStart(TCP_SOCKET sslsock)
 {
-    BOOL opok = FALSE;
-    while (!opok)
+    BYTE sslStartStat;
+    FRONTEND_REQ* req = FrontEndLock();
+    //	If WiFi module if turned OFF, function doesn't do anything
+    if (req == NULL)
+	return 1;
+    req->sock = sslsock;
+    if (FrontEndCall(req, 15) != 0)								//	Waits for stack answer
     {
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	if (xFrontEndStat == 0)
-	{
-	    ToSend = 15;
-	    xFrontEndStatRet = 2;
-	    xSocket = sslsock;
-	    xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPRxLen request to the stack
-	    xFrontEndStat = 1;
-	    xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-	    opok = TRUE;
-	}
-	else
-	{
-	    xSemaphoreGive(xSemFrontEnd);
-	    taskYIELD();
-	    //	If WiFi module if turned OFF, function doesn't do anything
-	    if (xFrontEndStat == -1)
-		return 1;
-	}
+	FrontEndUnlock(req);
+	return 1;
     }
-
-    while (xFrontEndStat != 2);								//	Waits for stack answer
-    while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-    BYTE sslStartStat;
-    sslStartStat = xByte2;
-    xFrontEndStat = 0;
-    xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-    //taskYIELD();
+    sslStartStat = (BYTE) req->res;
+    FrontEndUnlock(req);
     return sslStartStat;
 }
 
-int cTCPSSLStart()
+int cTCPSSLStart(FRONTEND_REQ* req)
 {
-    if(TCPStartSSLClient(xSocket, (BYTE*) "2"))
+    if(TCPStartSSLClient(req->sock, (BYTE*) "2"))
     {
-		xByte2 = 0;
+		req->res = 0;
 		return 0;
     }
     else
     {
-		xByte2 = 2;
+		req->res = 2;
     }
     return 0;
 }
@@ -175,49 +238,20 @@ int cTCPSSLStart()
 //****************************************************************************
 TCP_SOCKET TCPGenericOpen(char ipaddr[] , BYTE remhost , char tcpport[] , BYTE type)
 {
-	BOOL opok = FALSE;
-	//	Function cycles until it is not executed
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		//	Check on xFrontEndStat, if TCP stck is currently in use, is different from 0
-		if (xFrontEndStat == 0)
-		{	
-			xFrontEndStatRet = 2;	
-			ToSend=20;
-		
-			xTCPPort = atoi(tcpport);
-			int termChar = strlen(ipaddr);
-			if(termChar > 100) // xIPAddress array size is 100
-				termChar = 100;
-			strncpy((char*)xIPAddress, ipaddr, termChar);
-			xIPAddress[termChar] = '\0';
-			xByte2 = type;
-			xByte3 = remhost;
-			
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND request to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE, the stack can answer to the command
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return INVALID_SOCKET;
-		}
-	}
-		
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	TCP_SOCKET retsock;
-	retsock = xSocket;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE, the stack can answer to the command
-	taskYIELD();
+	TCP_SOCKET retsock = INVALID_SOCKET;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return INVALID_SOCKET;
+
+	req->port = atoi(tcpport);
+	req->str = ipaddr;
+	req->type = type;
+	req->remhost = remhost;
+	
+	if (FrontEndCall(req, 20) == 0)								//	Waits for stack answer
+		retsock = (TCP_SOCKET) req->res;
+	FrontEndUnlock(req);
 	return retsock;
 }
 
@@ -225,10 +259,22 @@ TCP_SOCKET TCPGenericOpen(char ipaddr[] , BYTE remhost , char tcpport[] , BYTE t
 //	Only internal use:
 //	TCPGenericOpen callback function
 //****************************************************************************
-int cTCPGenericOpen()
+int cTCPGenericOpen(FRONTEND_REQ* req)
 { 
-	xSocket = INVALID_SOCKET;
-	xSocket = TCPOpen((DWORD)&xIPAddress[0], xByte3 , xTCPPort, xByte2);
+	//	The stack keeps using the host name while resolving it, so it's 
+	//	copied from the caller memory
+	int termChar = strlen(req->str);
+	if(termChar > 100) // xIPAddress array size is 100
+		termChar = 100;
+	strncpy((char*)xIPAddress, req->str, termChar);
+	xIPAddress[termChar] = '\0';
+	req->res = TCPOpen((DWORD)&xIPAddress[0], req->remhost , req->port, req->type);
+	if (req->res != INVALID_SOCKET)
+	{
+		if (req->res < TCP_SNAP_SOCKETS)
+			TCPCorked[req->res] = FALSE;
+		_TCPSnapSocket(req->res);
+	}
 	return 0;
 }
 
@@ -239,46 +285,26 @@ int cTCPGenericOpen()
 //****************************************************************************
 void TCPGenericClose(TCP_SOCKET sockclose)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			xFrontEndStatRet = 2;
-			ToSend=23;
-			xSocket = sockclose;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE, the stack can answer to the command	
-		
-			while (xFrontEndStat != 2);							//	Waits for stack answer
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-			xFrontEndStat = 0;
-			xSemaphoreGive(xSemFrontEnd);	
-			opok = TRUE;
-			taskYIELD();
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
-	}
-
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = sockclose;
+	FrontEndCall(req, 23);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 //****************************************************************************
 //	Only internal use:
 //	TCPGenericClose callback function
 //****************************************************************************
-int cTCPGenericClose()
+int cTCPGenericClose(FRONTEND_REQ* req)
 {
-	TCPClose(xSocket);
+	int ring = _TCPRing(req->sock);
+	TCPClose(req->sock);
+	if (ring >= 0)
+		RxRings[ring].sock = INVALID_SOCKET;
+	_TCPSnapSocket(req->sock);
 	return 0;
 }
 /// @endcond
@@ -292,36 +318,13 @@ int cTCPGenericClose()
  */
 void TCPServerDetach(TCP_SOCKET sockdet)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			xFrontEndStatRet = 2;
-			ToSend=19;
-			xSocket = sockdet;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			while (xFrontEndStat != 2);							//	Waits for stack answer
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-			xFrontEndStat = 0;
-			xSemaphoreGive(xSemFrontEnd);	
-			opok = TRUE;
-			taskYIELD();		
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
-	}
-
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = sockdet;
+	FrontEndCall(req, 19);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 /// @cond debug
@@ -329,9 +332,10 @@ void TCPServerDetach(TCP_SOCKET sockdet)
 //	Only internal use:
 //	TCPServerDetach callback function
 //****************************************************************************
-int cTCPServerDetach()
+int cTCPServerDetach(FRONTEND_REQ* req)
 {
-	TCPDisconnect(xSocket);
+	TCPDisconnect(req->sock);
+	_TCPSnapSocket(req->sock);
 	return 0;
 }
 /// @endcond
@@ -372,38 +376,24 @@ TCP_SOCKET TCPServerOpen (char tcpport[])
  */
 void TCPRead(TCP_SOCKET socktoread , char readch[] , int rlen)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	FRONTEND_REQ* req;
+	int ring = _TCPRing(socktoread);
+	//	With an RX ring the data is read locally
+	if (ring >= 0)
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			ToSend=21;
-			xFrontEndStatRet = 2;
-			xSocket = socktoread;
-			xInt = rlen;
-			xByte = (BYTE*)readch;
-			xQueueSendToBack(xQueue,&ToSend,0);						//	Send READFTP command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-			while (xFrontEndStat != 2);								//	Waits for stack answer
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE	
-			xFrontEndStat = 0;
-			xSemaphoreGive(xSemFrontEnd);	
-			opok = TRUE;
-			taskYIELD();
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
+		_TCPRingRead(ring, (BYTE*)readch, rlen);
+		readch[rlen] = '\0';
+		return;
 	}
-
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = socktoread;
+	req->len = rlen;
+	req->data = (BYTE*)readch;
+	FrontEndCall(req, 21);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 /**
@@ -417,53 +407,45 @@ void TCPRead(TCP_SOCKET socktoread , char readch[] , int rlen)
 */
 void TCPpRead(TCP_SOCKET socktoread , char readch[] , int rlen, int start)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	FRONTEND_REQ* req;
+	int ring = _TCPRing(socktoread);
+	//	With an RX ring the data is peeked locally
+	if (ring >= 0)
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);			//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			ToSend=17;
-			xFrontEndStatRet = 2;
-			xSocket = socktoread;
-			xInt = rlen;
-			xInt2 = start;
-			xByte = (BYTE*)readch;
-			xQueueSendToBack(xQueue,&ToSend,0);						//	Send cTCPRead command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-			while (xFrontEndStat != 2);								//	Waits for stack answer
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE	
-			xFrontEndStat = 0;
-			xSemaphoreGive(xSemFrontEnd);	
-			opok = TRUE;
-			taskYIELD();
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
+		WORD avail = _TCPRingLen(socktoread);
+		if ((start < 0) || (start > avail))
+			start = avail;
+		if (rlen > avail - start)
+			rlen = avail - start;
+		_TCPRingCopy(ring, (BYTE*)readch, start, rlen);
+		readch[rlen] = '\0';
+		return;
 	}
- }
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = socktoread;
+	req->len = rlen;
+	req->start = start;
+	req->data = (BYTE*)readch;
+	FrontEndCall(req, 17);									//	Waits for stack answer
+	FrontEndUnlock(req);
+}
  
  /// @cond debug
  //***************************************************************************
  //	 Only internal ude:
  //  cTCPpRead callback function
  //***************************************************************************
-int cTCPpRead()
+int cTCPpRead(FRONTEND_REQ* req)
 {
 	WORD resbool;
 	BYTE* tempByte;
-	tempByte = (BYTE*)xByte;
-	if(xInt2 > xInt)
-		xInt2 = xInt;
-	resbool = TCPPeekArray(xSocket, xByte, xInt, xInt2);
+	tempByte = req->data;
+	if(req->start > req->len)
+		req->start = req->len;
+	resbool = TCPPeekArray(req->sock, req->data, req->len, req->start);
 	if(resbool > 0)
 	{
 		*(tempByte+resbool) = '\0';
@@ -483,16 +465,147 @@ int cTCPpRead()
 //	Only internal use:
 //	cTCPRead callback function
 //****************************************************************************
-int cTCPRead()
+int cTCPRead(FRONTEND_REQ* req)
 {
 	WORD resbool;
-	resbool = TCPGetArray(xSocket , xByte , xInt); 
-	*(xByte+xInt)='\0';
+	resbool = TCPGetArray(req->sock , req->data , req->len); 
+	*(req->data+req->len)='\0';
+	_TCPSnapSocket(req->sock);
 	return (int) resbool;
 }
 /// @endcond
 
 
+/**
+ * Reads the characters available on a TCP socket, up to the specified number, and puts them into the specified char array.
+ * Unlike TCPRead, there's no need to call TCPRxLen first: length check and read are done with a single request to the stack.
+ * \param socktoread - The handle of the socket to read (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \param readch - The char array to fill with the read characters.
+ * \param maxlen - The maximum number of characters to read. 
+ * \warning The length of the array must be AT LEAST = maxlen+1, because at the end of the operation the array it's automatically NULL terminated (is added the '\0' character).
+ * \return The number of characters read.
+ */
+WORD TCPReadMax(TCP_SOCKET socktoread , char readch[] , int maxlen)
+{
+	WORD resread;
+	FRONTEND_REQ* req;
+	int ring = _TCPRing(socktoread);
+	//	With an RX ring the data is read locally
+	if (ring >= 0)
+		return _TCPRingRead(ring, (BYTE*)readch, maxlen);
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->sock = socktoread;
+	req->len = maxlen;
+	req->data = (BYTE*)readch;
+	if (FrontEndCall(req, TCP_READMAX) != 0)					//	Waits for stack answer
+	{
+		FrontEndUnlock(req);
+		return 0;
+	}
+	resread = req->res;
+	FrontEndUnlock(req);
+	return resread;
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPReadMax callback function
+//****************************************************************************
+int cTCPReadMax(FRONTEND_REQ* req)
+{
+	req->res = TCPGetArray(req->sock , req->data , req->len);
+	*(req->data+req->res)='\0';
+	_TCPSnapSocket(req->sock);
+	return (int) req->res;
+}
+/// @endcond
+
+
+/**
+ * Executes a list of operations on TCP sockets with a single request to the stack. The operations are executed in order
+ * by the TCP/IP task without interruptions, so for example a write, a flush and a read of the answer already received
+ * cost a single round trip. The result of each operation is written in the field res of its element.
+ * \param ops - Array of TCP_OP: operation (TCP_OP_PUT, TCP_OP_FLUSH, TCP_OP_READ, TCP_OP_RXLEN, TCP_OP_RXFLUSH, TCP_OP_ISCONN), socket, data and length.
+ * \param opcnt - The number of elements of ops.
+ * \warning For TCP_OP_READ the length of data must be AT LEAST = len+1, because it's automatically NULL terminated.
+ * \return The number of operations executed, -1 if the stack could not be reached.
+ */
+int TCPBatch(TCP_OP* ops , int opcnt)
+{
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return -1;
+	req->data = (BYTE*) ops;
+	req->len = opcnt;
+	if (FrontEndCall(req, TCP_BATCH) != 0)						//	Waits for stack answer
+	{
+		FrontEndUnlock(req);
+		return -1;
+	}
+	FrontEndUnlock(req);
+	return opcnt;
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPBatch callback function
+//****************************************************************************
+int cTCPBatch(FRONTEND_REQ* req)
+{
+	TCP_OP* op = (TCP_OP*) req->data;
+	int i, ring;
+	
+	for (i = 0; i < req->len; i++, op++)
+	{
+		switch (op->op)
+		{
+			case TCP_OP_PUT:
+				op->res = TCPPutArray(op->sock , (BYTE*) op->data , op->len);
+				break;
+			case TCP_OP_FLUSH:
+				TCPFlush(op->sock);
+				op->res = 0;
+				break;
+			case TCP_OP_READ:
+				ring = _TCPRing(op->sock);
+				if (ring >= 0)
+					op->res = _TCPRingRead(ring, (BYTE*) op->data, op->len);
+				else
+				{
+					op->res = TCPGetArray(op->sock , (BYTE*) op->data , op->len);
+					op->data[op->res] = '\0';
+				}
+				break;
+			case TCP_OP_RXLEN:
+				op->res = TCPIsGetReady(op->sock) + _TCPRingLen(op->sock);
+				break;
+			case TCP_OP_RXFLUSH:
+				ring = _TCPRing(op->sock);
+				if (ring >= 0)
+					RxRings[ring].tail = RxRings[ring].head;
+				TCPDiscard(op->sock);
+				op->res = 0;
+				break;
+			case TCP_OP_ISCONN:
+				op->res = TCPIsConnected(op->sock);
+				break;
+			default:
+				op->res = 0;
+				break;
+		}
+		_TCPSnapSocket(op->sock);
+	}
+	return 0;
+}
+/// @endcond
+
+
 /**
  * Writes an array of characters on the specified socket.
  * \param socktowrite - The socket to which data is to be written (it's the handle returned by the command TCPClientOpen or TCPServerOpen).
@@ -502,42 +615,22 @@ int cTCPRead()
  */
 WORD TCPWrite(TCP_SOCKET socktowrite , char* writech , int wlen)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	WORD reswrite;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->sock = socktowrite;
+	req->data = (BYTE*) writech;
+	req->len = wlen;
+	if (FrontEndCall(req, 22) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 22;
-			xFrontEndStatRet = 2;
-			xSocket = socktowrite;
-			xByte = (BYTE*) writech;
-			xInt = wlen;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPWrite command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return 0;
-		}
+		FrontEndUnlock(req);
+		return 0;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	WORD reswrite;
-	reswrite = xWord;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	reswrite = req->res;
+	FrontEndUnlock(req);
 	return reswrite;
-
 }
 
 /// @cond debug
@@ -545,11 +638,115 @@ WORD TCPWrite(TCP_SOCKET socktowrite , char* writech , int wlen)
 //	Only internal use:
 //	cTCPWrite callback function
 //****************************************************************************
-int cTCPWrite()
+int cTCPWrite(FRONTEND_REQ* req)
+{
+	req->res = TCPPutArray(req->sock , req->data , req->len);
+	//	A corked socket is flushed only when the TX buffer is full
+	if ((req->sock >= TCP_SNAP_SOCKETS) || !TCPCorked[req->sock] || (req->res < req->len))
+		TCPFlush(req->sock);
+	_TCPSnapSocket(req->sock);
+	return req->res;
+}
+/// @endcond
+
+
+/**
+ * Sets the corked mode of a socket. While corked, TCPWrite only puts the data in the TX buffer, so several small writes
+ * go out in a single TCP segment; the data is sent with TCPFlushNow, when the socket is uncorked or when the TX buffer is full.
+ * \param sockcork - The handle of the socket (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \param cork - TRUE to cork the socket, FALSE to uncork it and send the pending data.
+ * \return None.
+ */
+void TCPCork(TCP_SOCKET sockcork , BOOL cork)
+{
+	if (sockcork >= TCP_SNAP_SOCKETS)
+		return;
+	TCPCorked[sockcork] = cork;
+	if (!cork)
+		TCPFlushNow(sockcork);
+}
+
+
+/**
+ * Sends immediately the data in the TX buffer of the specified socket, written by TCPWrite while the socket was corked.
+ * \param sockflush - The handle of the socket (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \return None.
+ */
+void TCPFlushNow(TCP_SOCKET sockflush)
+{
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = sockflush;
+	FrontEndCall(req, TCP_FLUSH);							//	Waits for stack answer
+	FrontEndUnlock(req);
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPFlushNow callback function
+//****************************************************************************
+int cTCPFlushNow(FRONTEND_REQ* req)
+{
+	TCPFlush(req->sock);
+	_TCPSnapSocket(req->sock);
+	return 0;
+}
+/// @endcond
+
+
+/**
+ * Writes a list of arrays of characters on the specified socket with a single request to the stack. The arrays are
+ * put in the TX buffer in order and the socket is flushed once at the end, so no staging copy of the data is needed.
+ * \param socktowrite - The socket to which data is to be written (it's the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \param iov - Array of TCP_IOVEC, each one with the pointer and the number of the characters to write.
+ * \param iovcnt - The number of elements of iov.
+ * \return The number of bytes written to the socket. If less than the total length, the buffer became full or the socket is not conected.
+ */
+WORD TCPWriteV(TCP_SOCKET socktowrite , TCP_IOVEC* iov , int iovcnt)
+{
+	WORD reswrite;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->sock = socktowrite;
+	req->data = (BYTE*) iov;
+	req->len = iovcnt;
+	if (FrontEndCall(req, TCP_WRITEV) != 0)								//	Waits for stack answer
+	{
+		FrontEndUnlock(req);
+		return 0;
+	}
+	reswrite = req->res;
+	FrontEndUnlock(req);
+	return reswrite;
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPWriteV callback function
+//****************************************************************************
+int cTCPWriteV(FRONTEND_REQ* req)
 {
-	xWord = TCPPutArray(xSocket , xByte , xInt);
-	TCPFlush(xSocket);
-	return xWord;
+	TCP_IOVEC* iov = (TCP_IOVEC*) req->data;
+	WORD put;
+	int i;
+	
+	req->res = 0;
+	for (i = 0; i < req->len; i++)
+	{
+		put = TCPPutArray(req->sock , (BYTE*) iov[i].data , iov[i].len);
+		req->res += put;
+		if (put < iov[i].len)
+			break;
+	}
+	TCPFlush(req->sock);
+	_TCPSnapSocket(req->sock);
+	return req->res;
 }
 /// @endcond
 
@@ -563,51 +760,29 @@ int cTCPWrite()
  */
 NODE_INFO TCPRemote(TCP_SOCKET remotesock)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 18;
-			xFrontEndStatRet = 2;
-			xSocket = remotesock;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPRemote command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return xNode;
-		}
-	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
 	NODE_INFO resremote;
-	resremote = xNode;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	FRONTEND_REQ* req;
+	memset(&resremote, 0, sizeof(resremote));
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return resremote;
+	req->sock = remotesock;
+	req->out = &resremote;
+	FrontEndCall(req, 18);										//	Waits for stack answer
+	FrontEndUnlock(req);
 	return resremote;
-
 }
 
 /// @cond debug
 //****************************************************************************
 //	TCPRemote callback function
 //****************************************************************************
-int cTCPRemote()
+int cTCPRemote(FRONTEND_REQ* req)
 {
 	SOCKET_INFO* remote_sock;
-	remote_sock = TCPGetRemoteInfo(xSocket);
-	xNode = remote_sock -> remote;
+	remote_sock = TCPGetRemoteInfo(req->sock);
+	*(NODE_INFO*) req->out = remote_sock -> remote;
 	return 0;
 }
 /// @endcond
@@ -646,37 +821,23 @@ void TCPServerClose(TCP_SOCKET Sockclose)
  */
 BOOL TCPisConn(TCP_SOCKET sockconn)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	BOOL resconn;
+	FRONTEND_REQ* req;
+	//	Fast path: state published by the TCP/IP task
+	if (sockconn < TCP_SNAP_SOCKETS)
+		return (xFrontEndStat == -1) ? FALSE : TCPSnap[sockconn].conn;
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return FALSE;
+	req->sock = sockconn;
+	if (FrontEndCall(req, 24) != 0)								//	Waits for stack answer
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend = 24;
-			xFrontEndStatRet = 2;
-			xSocket = sockconn;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPIsConnected command to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return FALSE;
-		}
+		FrontEndUnlock(req);
+		return FALSE;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	BOOL resconn;
-	resconn = xBool;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	resconn = (BOOL) req->res;
+	FrontEndUnlock(req);
 	return resconn;
 }
 
@@ -684,10 +845,10 @@ BOOL TCPisConn(TCP_SOCKET sockconn)
 //****************************************************************************
 //	TCPIsConn callback function
 //****************************************************************************
-int cTCPisConn()
+int cTCPisConn(FRONTEND_REQ* req)
 {
-	xBool = TCPIsConnected(xSocket);
-	return xBool;
+	req->res = TCPIsConnected(req->sock);
+	return req->res;
 }
 /// @endcond
 
@@ -699,45 +860,26 @@ int cTCPisConn()
  */
 void TCPRxFlush(TCP_SOCKET sockflush)
 {
-	BOOL opok = FALSE;
-	while (!opok)
-	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		if (xFrontEndStat == 0)
-		{	
-			xFrontEndStatRet = 2;
-			ToSend=16;
-			xSocket = sockflush;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE, the stack can answer to the command	
-		
-			while (xFrontEndStat != 2);							//	Waits for stack answer
-			while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-			xFrontEndStat = 0;
-			xSemaphoreGive(xSemFrontEnd);	
-			opok = TRUE;
-			taskYIELD();
-		}
-		else
-		{
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
-		}
-	}
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = sockflush;
+	FrontEndCall(req, 16);									//	Waits for stack answer
+	FrontEndUnlock(req);
 }	
 
 /// @cond debug
 //****************************************************************************
 //	TCPRxFlush callback function
 //****************************************************************************
-int cTCPRxFlush()
+int cTCPRxFlush(FRONTEND_REQ* req)
 {
-	TCPDiscard(xSocket);
+	int ring = _TCPRing(req->sock);
+	if (ring >= 0)
+		RxRings[ring].tail = RxRings[ring].head;
+	TCPDiscard(req->sock);
+	_TCPSnapSocket(req->sock);
 	return 0;
 }	
 /// @endcond
@@ -749,47 +891,293 @@ int cTCPRxFlush()
  */
 WORD TCPRxLen(TCP_SOCKET socklen)
 {
-	BOOL opok = FALSE;
-	while (!opok)
+	WORD reslen;
+	FRONTEND_REQ* req;
+	//	Fast path: state published by the TCP/IP task
+	if (socklen < TCP_SNAP_SOCKETS)
+		return (xFrontEndStat == -1) ? 0 : TCPSnap[socklen].rxlen + _TCPRingLen(socklen);
+	req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return 0;
+	req->sock = socklen;
+	if (FrontEndCall(req, 25) != 0)								//	Waits for stack answer
+	{
+		FrontEndUnlock(req);
+		return 0;
+	}
+	reslen = req->res;
+	FrontEndUnlock(req);
+	return reslen;
+}
+
+/// @cond debug
+//****************************************************************************
+//	TCPRxLen callback function
+//****************************************************************************
+int cTCPRxLen(FRONTEND_REQ* req)
+{
+	req->res = TCPIsGetReady(req->sock) + _TCPRingLen(req->sock);
+	return 0;
+}
+/// @endcond
+
+
+/**
+ * Verifies how many bytes can be written on the specified TCP socket. Like TCPisConn and TCPRxLen it reads the state
+ * published by the TCP/IP task in each loop, so it doesn't wait for the stack.
+ * \param sockfree - The handle of the socket to control (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \return The free space in the TX buffer.
+ */
+WORD TCPTxFree(TCP_SOCKET sockfree)
+{
+	if ((xFrontEndStat == -1) || (sockfree >= TCP_SNAP_SOCKETS))
+		return 0;
+	return TCPSnap[sockfree].txfree;
+}
+
+
+/**
+ * Waits until at least the specified number of bytes can be read from a TCP socket, without polling the stack:
+ * the calling task sleeps and it's woken up by the TCP/IP task as soon as the data arrives, or the connection is closed.
+ * When more than TCP_RX_WAITERS tasks wait at the same time, the others poll the socket every 10ms until the timeout.
+ * \param sockwait - The handle of the socket to wait on (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \param minlen - The number of bytes to wait for.
+ * \param timeout - The maximum time to wait, in RTOS ticks.
+ * \return The number of bytes available to be read (less than minlen on timeout or if the connection was closed).
+ */
+WORD TCPRxWait(TCP_SOCKET sockwait, WORD minlen, portTickType timeout)
+{
+	int i;
+	WORD ready;
+	BOOL woken;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < TCP_RX_WAITERS; i++)
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		if (xFrontEndStat == 0)
-		{	
-			ToSend=25;
-			xFrontEndStatRet = 2;
-			xSocket = socklen;
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send TCPRxLen request to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-			opok = TRUE;
+		if (RxWaiters[i].state == RXWAIT_FREE)
+		{
+			//	A wake up given after the timeout of the previous waiter is still pending
+			xSemaphoreTake(RxWaiters[i].sem, 0);
+			RxWaiters[i].sock = sockwait;
+			RxWaiters[i].minlen = minlen;
+			RxWaiters[i].state = RXWAIT_WAITING;
+			break;
 		}
-		else
+	}
+	taskEXIT_CRITICAL();
+	//	No free slot: polls until the data arrives or the timeout expires
+	if (i == TCP_RX_WAITERS)
+	{
+		portTickType start = xTaskGetTickCount();
+		ready = TCPRxLen(sockwait);
+		while ((ready < minlen) && TCPisConn(sockwait) && 
+				((portTickType) (xTaskGetTickCount() - start) < timeout))
 		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return 0;
+			vTaskDelay(1);
+			ready = TCPRxLen(sockwait);
 		}
+		return ready;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	WORD reslen;
-	reslen = xWord;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	//taskYIELD();
-	return reslen;
+
+	xSemaphoreTake(RxWaiters[i].sem, timeout);
+	taskENTER_CRITICAL();
+	woken = (RxWaiters[i].state == RXWAIT_READY);
+	ready = RxWaiters[i].ready;
+	RxWaiters[i].state = RXWAIT_FREE;
+	taskEXIT_CRITICAL();
+
+	if (!woken)
+		ready = TCPRxLen(sockwait);
+	return ready;
 }
 
 /// @cond debug
 //****************************************************************************
-//	TCPRxLen callback function
+//	Only internal use:
+//	creates the semaphores used to wake up the tasks in TCPRxWait and
+//	frees the RX rings
+//****************************************************************************
+void TCPRxWaitInit()
+{
+	int i;
+	for (i = 0; i < TCP_RX_WAITERS; i++)
+	{
+		RxWaiters[i].state = RXWAIT_FREE;
+		vSemaphoreCreateBinary(RxWaiters[i].sem);
+		xSemaphoreTake(RxWaiters[i].sem, 0);
+	}
+	for (i = 0; i < TCP_RX_RINGS; i++)
+		RxRings[i].sock = INVALID_SOCKET;
+}
+
+//****************************************************************************
+//	Only internal use:
+//	called by the TCP/IP task after StackTask to wake up the waiting tasks
+//****************************************************************************
+void TCPRxWaitCheck()
+{
+	int i;
+	WORD ready;
+	for (i = 0; i < TCP_RX_WAITERS; i++)
+	{
+		if (RxWaiters[i].state != RXWAIT_WAITING)
+			continue;
+		ready = TCPIsGetReady(RxWaiters[i].sock) + _TCPRingLen(RxWaiters[i].sock);
+		if ((ready >= RxWaiters[i].minlen) || !TCPIsConnected(RxWaiters[i].sock))
+		{
+			BOOL wake = FALSE;
+			taskENTER_CRITICAL();
+			if (RxWaiters[i].state == RXWAIT_WAITING)
+			{
+				RxWaiters[i].ready = ready;
+				RxWaiters[i].state = RXWAIT_READY;
+				wake = TRUE;
+			}
+			taskEXIT_CRITICAL();
+			if (wake)
+				xSemaphoreGive(RxWaiters[i].sem);
+		}
+	}
+}
+/// @endcond
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	called by the TCP/IP task after StackTask to publish the state of the 
+//	sockets read by TCPisConn, TCPRxLen and TCPTxFree
 //****************************************************************************
-int cTCPRxLen()
+void TCPSnapUpdate()
 {
-	xWord = TCPIsGetReady(xSocket);
+	TCP_SOCKET sock;
+	for (sock = 0; sock < TCP_SNAP_SOCKETS; sock++)
+		_TCPSnapSocket(sock);
+}
+/// @endcond
+
+
+/**
+ * Turns on the RX ring of a TCP socket. The TCP/IP task moves the data received on the socket into the ring as soon as
+ * it arrives, and TCPRead, TCPReadMax, TCPpRead and TCPRxLen are served from the ring without waiting for the stack.
+ * Data not fitting in the ring is left in the socket, so nothing is lost. The ring is turned off by TCPRxRingOff or
+ * when the socket is closed.
+ * \param sockring - The handle of the socket (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \param ringbuf - The buffer for the ring, it must be available until the ring is turned off.
+ * \param ringsize - The size of ringbuf, the ring can hold ringsize-1 bytes.
+ * \return TRUE - The ring is on.
+ * \return FALSE - No free ring (see TCP_RX_RINGS) or the WiFi module is turned off.
+ */
+BOOL TCPRxRingOn(TCP_SOCKET sockring , BYTE* ringbuf , WORD ringsize)
+{
+	BOOL reson;
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return FALSE;
+	req->sock = sockring;
+	req->data = ringbuf;
+	req->len = ringsize;
+	if (FrontEndCall(req, TCP_RING_ON) != 0)					//	Waits for stack answer
+	{
+		FrontEndUnlock(req);
+		return FALSE;
+	}
+	reson = (BOOL) req->res;
+	FrontEndUnlock(req);
+	return reson;
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPRxRingOn callback function
+//****************************************************************************
+int cTCPRxRingOn(FRONTEND_REQ* req)
+{
+	int i = _TCPRing(req->sock);
+	req->res = FALSE;
+	if ((req->sock == INVALID_SOCKET) || (req->len < 2))
+		return 0;
+	if (i < 0)
+	{
+		for (i = 0; i < TCP_RX_RINGS; i++)
+			if (RxRings[i].sock == INVALID_SOCKET)
+				break;
+		if (i == TCP_RX_RINGS)
+			return 0;
+	}
+	RxRings[i].buf = req->data;
+	RxRings[i].size = req->len;
+	RxRings[i].head = 0;
+	RxRings[i].tail = 0;
+	RxRings[i].sock = req->sock;
+	req->res = TRUE;
 	return 0;
 }
 /// @endcond
+
+
+/**
+ * Turns off the RX ring of a TCP socket, the data still in the ring is discarded.
+ * \param sockring - The handle of the socket (the handle returned by the command TCPClientOpen or TCPServerOpen).
+ * \return None.
+ */
+void TCPRxRingOff(TCP_SOCKET sockring)
+{
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->sock = sockring;
+	FrontEndCall(req, TCP_RING_OFF);						//	Waits for stack answer
+	FrontEndUnlock(req);
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	cTCPRxRingOff callback function
+//****************************************************************************
+int cTCPRxRingOff(FRONTEND_REQ* req)
+{
+	int i = _TCPRing(req->sock);
+	if (i >= 0)
+		RxRings[i].sock = INVALID_SOCKET;
+	return 0;
+}
+
+//****************************************************************************
+//	Only internal use:
+//	called by the TCP/IP task after StackTask to move the received data 
+//	into the RX rings
+//****************************************************************************
+void TCPRxRingFill()
+{
+	int i;
+	WORD ready, space, first, head;
+	for (i = 0; i < TCP_RX_RINGS; i++)
+	{
+		if (RxRings[i].sock == INVALID_SOCKET)
+			continue;
+		ready = TCPIsGetReady(RxRings[i].sock);
+		space = RxRings[i].size - 1 - _TCPRingLen(RxRings[i].sock);
+		if (ready > space)
+			ready = space;
+		if (ready == 0)
+			continue;
+		head = RxRings[i].head;
+		first = RxRings[i].size - head;
+		if (first > ready)
+			first = ready;
+		TCPGetArray(RxRings[i].sock, RxRings[i].buf + head, first);
+		if (ready > first)
+			TCPGetArray(RxRings[i].sock, RxRings[i].buf, ready - first);
+		head += ready;
+		if (head >= RxRings[i].size)
+			head -= RxRings[i].size;
+		//	Published after the copy, the reader never sees missing data
+		RxRings[i].head = head;
+	}
+}
+/// @endcond
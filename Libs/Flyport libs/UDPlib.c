@@ -70,9 +70,72 @@ UDP provides the commands to manage UDP connections. Flyport supports the creati
 
 #if MAX_UDP_SOCKETS_FREERTOS>0
 
-static int ToSend = 0; 
 extern BOOL MACLinked;
 
+//	State of the RX buffers: records made by an UDP_DGRAM_HDR followed by 
+//	the data of the datagram, written at head by the TCP/IP task and read 
+//	from tail by the application. Indexes are changed in critical sections
+static struct
+{
+	WORD head;
+	WORD tail;
+	WORD offset;			//	Bytes of the oldest datagram already read by UDPRead
+	WORD count;				//	Datagrams in the buffer
+	WORD dropped;			//	Datagrams dropped because the buffer was full
+	BYTE policy;			//	UDP_DROP_NEWEST or UDP_DROP_OLDEST
+} udpRx[MAX_UDP_SOCKETS_FREERTOS];
+
+//	Only internal use: position len bytes after pos, wrapping around
+static WORD _UDPRingPos(BYTE socktmp, WORD pos, WORD len)
+{
+	pos += len;
+	if (pos >= BUFFER_UDP_LEN[socktmp])
+		pos -= BUFFER_UDP_LEN[socktmp];
+	return pos;
+}
+
+//	Only internal use: free bytes in the RX buffer
+static WORD _UDPRingFree(BYTE socktmp)
+{
+	WORD used;
+	if (udpRx[socktmp].head >= udpRx[socktmp].tail)
+		used = udpRx[socktmp].head - udpRx[socktmp].tail;
+	else
+		used = BUFFER_UDP_LEN[socktmp] - udpRx[socktmp].tail + udpRx[socktmp].head;
+	return BUFFER_UDP_LEN[socktmp] - 1 - used;
+}
+
+//	Only internal use: copies from the RX buffer, in two pieces if the 
+//	data wraps around the end of the buffer
+static void _UDPRingGet(BYTE socktmp, WORD pos, BYTE* dst, WORD len)
+{
+	WORD first = BUFFER_UDP_LEN[socktmp] - pos;
+	if (first > len)
+		first = len;
+	memcpy(dst, udpBuffer[socktmp] + pos, first);
+	if (len > first)
+		memcpy(dst + first, udpBuffer[socktmp], len - first);
+}
+
+//	Only internal use: copies into the RX buffer, in two pieces if needed
+static void _UDPRingPut(BYTE socktmp, WORD pos, BYTE* src, WORD len)
+{
+	WORD first = BUFFER_UDP_LEN[socktmp] - pos;
+	if (first > len)
+		first = len;
+	memcpy(udpBuffer[socktmp] + pos, src, first);
+	if (len > first)
+		memcpy(udpBuffer[socktmp], src + first, len - first);
+}
+
+//	Only internal use: removes the oldest datagram, with header hdr
+static void _UDPRxDrop(BYTE socktmp, UDP_DGRAM_HDR* hdr)
+{
+	udpRx[socktmp].tail = _UDPRingPos(socktmp, udpRx[socktmp].tail, sizeof(UDP_DGRAM_HDR) + hdr->len);
+	udpRx[socktmp].offset = 0;
+	udpRx[socktmp].count--;
+}
+
 /// @cond debug
 //*****************************************************************************************
 // Only internal use:
@@ -81,56 +144,43 @@ extern BOOL MACLinked;
 BYTE UDPGenericOpen(char localport[], DWORD remhost, char remoteport[], BYTE connType )
 {
 	BYTE retsock;
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-	xErr = 0;
-	if (xFrontEndStat == 0)
-	{	
-		//	OpCode and requested return value from the stack
-		xFrontEndStatRet = 2;	
-		ToSend = 35;
-		
-		//	Passing function parameters
-		//	The remote host type is always UDP_OPEN_RAM_HOST, so it's passed as pointer to a char
-		xUDPLocalPort = atoi(localport);				//	Local port is set to 0 by calling functions, so it's managed by TCP/IP stack
-		xUDPRemotePort = atoi(remoteport);				//	Remote port is passed directly by calling function				
-		xUDPRemoteHost = (DWORD)(unsigned int)remhost;	//	Double casting to make compiler happy
-		xByte2 = connType;								// Connection type, containg the format of the server
-		
-		//	Queue and status setting, callback is ready to be fired when semaphore is released
-		xQueueSendToBack(xQueue,&ToSend,0);				//	Send COMMAND to the stack
-		xFrontEndStat = 1;
-		xSemaphoreGive(xSemFrontEnd);					//	xSemFrontEnd GIVE
-	}
-	else
+	FRONTEND_REQ* req = FrontEndLock();
+	if (req == NULL)
 	{
-		xErr = 35; 	// Error code = ToSend, it can be changed from callback function to manage different cases
-		xSemaphoreGive(xSemFrontEnd);
-		taskYIELD();
+		xErr = 35;
 		return 0;	//Socket creation error
 	}
 	
-	while (xFrontEndStat != 2);							//	Waits for stack answer
+	//	Passing function parameters
+	//	The remote host type is always UDP_OPEN_RAM_HOST, so it's passed as pointer to a char
+	req->port = atoi(localport);					//	Local port is set to 0 by calling functions, so it's managed by TCP/IP stack
+	req->remport = atoi(remoteport);				//	Remote port is passed directly by calling function				
+	req->remaddr = (DWORD)(unsigned int)remhost;	//	Double casting to make compiler happy
+	req->type = connType;							// Connection type, containg the format of the server
+	
+	if (FrontEndCall(req, 35) != 0)						//	Waits for stack answer
+	{
+		xErr = 35; 	// Error code = command, it can be changed from callback function to manage different cases
+		FrontEndUnlock(req);
+		return 0;	//Socket creation error
+	}
 	//	Stack performed the callback, reading the answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-	retsock = callbackUdpSocket;						//	The returning UDP socket, opened by callback
-	xFrontEndStat = 0;		
-	xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE
-	taskYIELD();
+	retsock = (BYTE) req->res;						//	The returning UDP socket, opened by callback
+	FrontEndUnlock(req);
 	return retsock;
 }
 
 //	UDPGenericOpen callback function
-int cUDPGenericOpen()
+int cUDPGenericOpen(FRONTEND_REQ* req)
 {
 	BYTE count = 0;
 	UDP_SOCKET tmp_sock = INVALID_UDP_SOCKET;
 
-	udpInt = 0;
-	//tmp_sock = UDPOpen(xUDPLocalPort, xUDPRemoteHost, xUDPRemotePort);
-	tmp_sock = UDPOpenEx(xUDPRemoteHost, xByte2, xUDPLocalPort, xUDPRemotePort);
+	//tmp_sock = UDPOpen(req->port, req->remaddr, req->remport);
+	tmp_sock = UDPOpenEx(req->remaddr, req->type, req->port, req->remport);
 	if (tmp_sock == INVALID_UDP_SOCKET)
 	{
-		callbackUdpSocket = 0;
+		req->res = 0;
 		return 1; // Error;
 	}
 	else
@@ -140,15 +190,16 @@ int cUDPGenericOpen()
 		{
 			if (udpSocket[count] == INVALID_UDP_SOCKET)
 			{
+				UDPRxReset(count);
 				udpSocket[count] = tmp_sock;
 				xUDPPort[count] = UDPSocketInfo[tmp_sock].localPort;
 				count++;
-				callbackUdpSocket = count;
+				req->res = count;
 				return 0; // Open succes
 			}
 			count++;
 		}
-		callbackUdpSocket = 0;
+		req->res = 0;
 		return 1; //Error
 	}
 	
@@ -216,37 +267,25 @@ BYTE UDPBroadcastOpen (char udpport[])
 //*****************************************************************************************
 BYTE UDPGenericClose(BYTE sock)
 {
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	xErr = 0;
-	if (xFrontEndStat == 0)
-	{	
-		xFrontEndStatRet = 2;
-		ToSend=37;
-		callbackUdpSocket = sock;
-		
-		xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND to the stack
-		xFrontEndStat = 1;
-		xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
-		while (xFrontEndStat != 2);							//	Waits for stack answer
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);	//	xSemFrontEnd TAKE
-		xFrontEndStat = 0;
-		xSemaphoreGive(xSemFrontEnd);	
-		taskYIELD();
-	}
-	else
+	FRONTEND_REQ* req = FrontEndLock();
+	if (req == NULL)
 	{
 		xErr = 37;
-		xSemaphoreGive(xSemFrontEnd);
-		taskYIELD();
+		return 0;
 	}
+	req->sock = sock;
+	if (FrontEndCall(req, 37) != 0)							//	Waits for stack answer
+		xErr = 37;
+	FrontEndUnlock(req);
 	return 0;
 }
 
 //	Callback function
-int cUDPGenericClose()
+int cUDPGenericClose(FRONTEND_REQ* req)
 {
-	UDPClose(udpSocket[callbackUdpSocket-1]);
-	udpSocket[callbackUdpSocket-1] = INVALID_UDP_SOCKET;
+	UDPClose(udpSocket[req->sock-1]);
+	udpSocket[req->sock-1] = INVALID_UDP_SOCKET;
+	UDPRxReset(req->sock-1);
 	numUdpSocket--;
 	return 0;
 }
@@ -274,13 +313,23 @@ BYTE UDPClientClose(BYTE sock)
 /**
  * Reads the length of the RX buffer
  * \param sock UDP socket number
- * \return The number of char that can be read from the UDP buffer.
+ * \return The number of char that can be read from the UDP buffer (data of all the datagrams received, without headers).
  */
 WORD UDPRxLen(BYTE sock)
 {
 	return udpRxLenGlobal[sock-1];
 }
 
+/**
+ * Reads the number of datagrams in the RX buffer
+ * \param sock UDP socket number
+ * \return The number of datagrams that can be read with UDPReadDatagram.
+ */
+WORD UDPRxDatagrams(BYTE sock)
+{
+	return udpRx[sock-1].count;
+}
+
 /**
  * Empty the RX buffer
  * \param sock UDP socket number
@@ -290,10 +339,12 @@ void UDPRxFlush(BYTE sock)
 {
 	BYTE socktmp;
 	socktmp = sock - 1;
-	p_udp_wifiram[socktmp] = udpBuffer[socktmp];
-	p_udp_data[socktmp] = p_udp_wifiram[socktmp];
-	*p_udp_data[socktmp] = 0;
+	taskENTER_CRITICAL();
+	udpRx[socktmp].tail = udpRx[socktmp].head;
+	udpRx[socktmp].offset = 0;
+	udpRx[socktmp].count = 0;
 	udpRxLenGlobal[socktmp] = 0;
+	taskEXIT_CRITICAL();
 }
 
 /**
@@ -313,7 +364,36 @@ BOOL UDPRxOver(BYTE sock)
 }
 
 /**
- * Reads lstr bytes from the RX buffer
+ * Reads the number of datagrams dropped because the RX buffer was full
+ * \param sock UDP socket number
+ * \param reset TRUE to clear the counter
+ * \return The number of dropped datagrams.
+ */
+WORD UDPRxDropped(BYTE sock, BOOL reset)
+{
+	WORD dropped;
+	taskENTER_CRITICAL();
+	dropped = udpRx[sock-1].dropped;
+	if (reset)
+		udpRx[sock-1].dropped = 0;
+	taskEXIT_CRITICAL();
+	return dropped;
+}
+
+/**
+ * Sets what is dropped when a datagram doesn't fit in the RX buffer
+ * \param sock UDP socket number
+ * \param policy UDP_DROP_NEWEST (default) to drop the datagram just received, UDP_DROP_OLDEST to drop the oldest datagrams in the buffer to make room for it
+ * \return none
+ */
+void UDPRxPolicy(BYTE sock, BYTE policy)
+{
+	udpRx[sock-1].policy = policy;
+}
+
+/**
+ * Reads lstr bytes from the RX buffer. The data of consecutive datagrams is read as a single stream, 
+ * use UDPReadDatagram to keep the datagrams separated.
  * \param sock UDP socket number
  * \param str2rd Buffer for data
  * \param lstr lenght of string
@@ -329,32 +409,26 @@ int UDPRead(BYTE sock, char str2rd[] , int lstr)
 	{
 		BYTE socktmp;
 		int tmpread = 0;
+		WORD part;
+		UDP_DGRAM_HDR hdr;
 		
 		socktmp = sock-1;
-		if (lstr > BUFFER_UDP_LEN[socktmp])  //overflow
-			lstr = BUFFER_UDP_LEN[socktmp];
-		
-		//doppiaggio dei dati da testare con pulsante
-		if (udpRxLenGlobal[socktmp] > BUFFER_UDP_LEN[socktmp])
+		taskENTER_CRITICAL();
+		while ((tmpread < lstr) && (udpRx[socktmp].count > 0))
 		{
-			udpRxLenGlobal[socktmp] = BUFFER_UDP_LEN[socktmp];
-			p_udp_data[socktmp] = p_udp_wifiram[socktmp];
-		}
-
-		while(tmpread < lstr)
-		{
-			str2rd[tmpread] = *p_udp_data[socktmp];
-			if ( p_udp_data[socktmp] < (udpBuffer[socktmp]+(BUFFER_UDP_LEN[socktmp]-1)) )
-			{
-				p_udp_data[socktmp]++;
-			}
-			else
-			{
-				p_udp_data[socktmp] = udpBuffer[socktmp];
-			}
-			tmpread++;
+			_UDPRingGet(socktmp, udpRx[socktmp].tail, (BYTE*) &hdr, sizeof(hdr));
+			part = hdr.len - udpRx[socktmp].offset;
+			if (part > lstr - tmpread)
+				part = lstr - tmpread;
+			_UDPRingGet(socktmp, _UDPRingPos(socktmp, udpRx[socktmp].tail, sizeof(hdr) + udpRx[socktmp].offset), 
+						(BYTE*) &str2rd[tmpread], part);
+			tmpread += part;
+			udpRx[socktmp].offset += part;
+			if (udpRx[socktmp].offset == hdr.len)
+				_UDPRxDrop(socktmp, &hdr);
 		}
 		udpRxLenGlobal[socktmp] -= tmpread;
+		taskEXIT_CRITICAL();
 		return tmpread;
 	}
 	return 0;
@@ -379,39 +453,175 @@ int UDPpRead(BYTE sock, char str2rd[], int lstr, int start)
 		BYTE socktmp;
 		socktmp = sock-1;
 		int tmpread = 0;
-		BYTE* peek;
-		peek = p_udp_data[socktmp]+start;
+		WORD pos, off, left, part;
+		UDP_DGRAM_HDR hdr;
 		
-		
-		if (lstr > (BUFFER_UDP_LEN[socktmp]-start))  //overflow
-			lstr = BUFFER_UDP_LEN[socktmp]-start;
-		
-		//doppiaggio dei dati da testare con pulsante
-		if (udpRxLenGlobal[socktmp] > BUFFER_UDP_LEN[socktmp])
+		taskENTER_CRITICAL();
+		pos = udpRx[socktmp].tail;
+		off = udpRx[socktmp].offset;
+		left = udpRx[socktmp].count;
+		while ((tmpread < lstr) && (left > 0))
 		{
-			udpRxLenGlobal[socktmp] = BUFFER_UDP_LEN[socktmp];
-			peek = p_udp_wifiram[socktmp];
-		}
-
-		while(tmpread < lstr)
-		{
-			str2rd[tmpread] = *peek;
-			if ( peek < (udpBuffer[socktmp]+(BUFFER_UDP_LEN[socktmp]-1)) )
+			_UDPRingGet(socktmp, pos, (BYTE*) &hdr, sizeof(hdr));
+			part = hdr.len - off;
+			//	Skips the first start bytes
+			if (start >= part)
 			{
-				peek++;
+				start -= part;
+				part = 0;
 			}
 			else
 			{
-				peek = udpBuffer[socktmp];
+				off += start;
+				part -= start;
+				start = 0;
+				if (part > lstr - tmpread)
+					part = lstr - tmpread;
+				_UDPRingGet(socktmp, _UDPRingPos(socktmp, pos, sizeof(hdr) + off), (BYTE*) &str2rd[tmpread], part);
+				tmpread += part;
 			}
-			tmpread++;
+			pos = _UDPRingPos(socktmp, pos, sizeof(hdr) + hdr.len);
+			off = 0;
+			left--;
 		}
-		//udpRxLenGlobal[socktmp] -= tmpread;
+		taskEXIT_CRITICAL();
 		return tmpread;
 	}
 	return 0;
 }	
 
+/**
+ * Reads the next datagram from the RX buffer. If the datagram is longer than lstr, the rest of it is discarded.
+ * \param sock UDP socket number
+ * \param str2rd Buffer for data
+ * \param lstr size of str2rd
+ * \param remhost if not NULL, filled with the IP address of the sender
+ * \param remport if not NULL, filled with the port of the sender
+ * \return The length of the datagram (it can be more than lstr), -1 if no datagram was received.
+ */
+int UDPReadDatagram(BYTE sock, char str2rd[], int lstr, DWORD* remhost, WORD* remport)
+{
+	BYTE socktmp;
+	WORD part;
+	UDP_DGRAM_HDR hdr;
+	
+	socktmp = sock-1;
+	taskENTER_CRITICAL();
+	if (udpRx[socktmp].count == 0)
+	{
+		taskEXIT_CRITICAL();
+		return -1;
+	}
+	_UDPRingGet(socktmp, udpRx[socktmp].tail, (BYTE*) &hdr, sizeof(hdr));
+	//	The start of the datagram may have been read by UDPRead
+	part = hdr.len - udpRx[socktmp].offset;
+	if (lstr < 0)
+		lstr = 0;
+	_UDPRingGet(socktmp, _UDPRingPos(socktmp, udpRx[socktmp].tail, sizeof(hdr) + udpRx[socktmp].offset), 
+				(BYTE*) str2rd, (part < lstr) ? part : lstr);
+	udpRxLenGlobal[socktmp] -= part;
+	_UDPRxDrop(socktmp, &hdr);
+	taskEXIT_CRITICAL();
+	if (remhost != NULL)
+		*remhost = hdr.remhost;
+	if (remport != NULL)
+		*remport = hdr.remport;
+	return part;
+}
+
+/// @cond debug
+//****************************************************************************
+//	Only internal use:
+//	called by the TCP/IP task to move the received datagrams into the 
+//	RX buffers, each one with its UDP_DGRAM_HDR
+//****************************************************************************
+void UDPRxFill()
+{
+	BYTE socktmp;
+	WORD len, first;
+	UDP_DGRAM_HDR hdr, old;
+	BOOL fits, evicted;
+	
+	for (socktmp = 0; socktmp < MAX_UDP_SOCKETS_FREERTOS; socktmp++)
+	{
+		if (udpSocket[socktmp] == INVALID_UDP_SOCKET)
+			continue;
+		len = UDPIsGetReady(udpSocket[socktmp]);
+		if (len == 0)
+			continue;
+			
+		//	Makes room for the datagram, unless it can't fit even in the 
+		//	empty buffer
+		evicted = FALSE;
+		taskENTER_CRITICAL();
+		if ((udpRx[socktmp].policy == UDP_DROP_OLDEST) && (sizeof(hdr) + len <= BUFFER_UDP_LEN[socktmp] - 1))
+		{
+			while ((_UDPRingFree(socktmp) < sizeof(hdr) + len) && (udpRx[socktmp].count > 0))
+			{
+				_UDPRingGet(socktmp, udpRx[socktmp].tail, (BYTE*) &old, sizeof(old));
+				udpRxLenGlobal[socktmp] -= old.len - udpRx[socktmp].offset;
+				_UDPRxDrop(socktmp, &old);
+				udpRx[socktmp].dropped++;
+				evicted = TRUE;
+			}
+		}
+		fits = (_UDPRingFree(socktmp) >= sizeof(hdr) + len);
+		if (!fits)
+			udpRx[socktmp].dropped++;
+		if (!fits || evicted)
+		{
+			UDPoverflow = 1;
+			UDPoverflowFlag[socktmp] = 1;
+		}
+		taskEXIT_CRITICAL();
+		
+		if (!fits)
+		{
+			//	Datagram dropped
+			UDPDiscard();
+			continue;
+		}
+		
+		//	The free part of the buffer is used only by the TCP/IP task
+		hdr.len = len;
+		hdr.remport = UDPSocketInfo[udpSocket[socktmp]].remotePort;
+		hdr.remhost = UDPSocketInfo[udpSocket[socktmp]].remote.remoteNode.IPAddr.Val;
+		_UDPRingPut(socktmp, udpRx[socktmp].head, (BYTE*) &hdr, sizeof(hdr));
+		first = _UDPRingPos(socktmp, udpRx[socktmp].head, sizeof(hdr));
+		if (first + len <= BUFFER_UDP_LEN[socktmp])
+			UDPGetArray(udpBuffer[socktmp] + first, len);
+		else
+		{
+			UDPGetArray(udpBuffer[socktmp] + first, BUFFER_UDP_LEN[socktmp] - first);
+			UDPGetArray(udpBuffer[socktmp], len - (BUFFER_UDP_LEN[socktmp] - first));
+		}
+		
+		taskENTER_CRITICAL();
+		udpRx[socktmp].head = _UDPRingPos(socktmp, udpRx[socktmp].head, sizeof(hdr) + len);
+		udpRx[socktmp].count++;
+		udpRxLenGlobal[socktmp] += len;
+		taskEXIT_CRITICAL();
+	}
+}
+
+//****************************************************************************
+//	Only internal use:
+//	empties the RX buffer of a socket slot, when it's opened or closed
+//****************************************************************************
+void UDPRxReset(BYTE socktmp)
+{
+	taskENTER_CRITICAL();
+	udpRx[socktmp].head = 0;
+	udpRx[socktmp].tail = 0;
+	udpRx[socktmp].offset = 0;
+	udpRx[socktmp].count = 0;
+	udpRx[socktmp].dropped = 0;
+	udpRxLenGlobal[socktmp] = 0;
+	UDPoverflowFlag[socktmp] = 0;
+	taskEXIT_CRITICAL();
+}
+/// @endcond
+
 /**
  * Writes on the UDP socket
  * \param sockwr UDP socket number
@@ -421,96 +631,148 @@ int UDPpRead(BYTE sock, char str2rd[], int lstr, int start)
  */
 WORD UDPWrite(BYTE sockwr, BYTE* str2wr , int lstr)
 {
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	xErr = 0;
-	if (xFrontEndStat == 0)
-	{	
-		ToSend = 36;
-		xFrontEndStatRet = 2;
-		callbackUdpSocket = sockwr;
-		udpByte = str2wr;
-		udpInt = lstr;
-		xQueueSendToBack(xQueue,&ToSend,0);					//	Send UDPWrite command to the stack
-		xFrontEndStat = 1;
-		xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE	
+	WORD resconn;
+	FRONTEND_REQ* req = FrontEndLock();
+	if (req == NULL)
+	{
+		xErr = 36;
+		return FALSE;
 	}
-	else
+	req->sock = sockwr;
+	req->data = str2wr;
+	req->len = lstr;
+	if (FrontEndCall(req, 36) != 0)								//	Waits for stack answer
 	{
 		xErr = 36;
-		xSemaphoreGive(xSemFrontEnd);
-		taskYIELD();
+		FrontEndUnlock(req);
 		return FALSE;
 	}
-	
-	while (xFrontEndStat != 2);								//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-	WORD resconn;
-	resconn = udpWord;
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);							//	xSemFrontEnd GIVE
-	taskYIELD();
+	resconn = req->res;
+	FrontEndUnlock(req);
 	return resconn;
 }
 
 /// @cond debug
-int cUDPWrite()
+int cUDPWrite(FRONTEND_REQ* req)
 {
 	//reads udp data and adds in ring buffer
-	if ( UDPIsPutReady(udpSocket[callbackUdpSocket-1]) )
+	if ( UDPIsPutReady(udpSocket[req->sock-1]) )
 	{
-		udpWord = UDPPutArray(udpByte,udpInt);
+		req->res = UDPPutArray(req->data,req->len);
 		UDPFlush();
 		return 0;
 	} else {
-		udpWord = 0;
+		req->res = 0;
 		return 1; //error
 	}
 }
 /// @endcond
 
+/**
+ * Sends a list of datagrams with a single request to the stack, each one with its own receiver.
+ * For broadcast and multicast receivers the MAC address of remnode is filled automatically, for the 
+ * others it must be already valid (for example from TCPRemote or ARPResolveMAC).
+ * \param sockwr UDP socket number
+ * \param dgram Array of UDP_DGRAM: data, length, receiver (NULL for the receiver of the socket) and port; 
+ *  the field res is filled with the number of bytes sent
+ * \param dgramcnt Number of elements of dgram
+ * \return The number of datagrams sent, -1 if the stack could not be reached.
+ */
+int UDPWriteV(BYTE sockwr, UDP_DGRAM* dgram, int dgramcnt)
+{
+	int ressent;
+	FRONTEND_REQ* req = FrontEndLock();
+	if (req == NULL)
+	{
+		xErr = UDP_WRITEV;
+		return -1;
+	}
+	req->sock = sockwr;
+	req->data = (BYTE*) dgram;
+	req->len = dgramcnt;
+	if (FrontEndCall(req, UDP_WRITEV) != 0)					//	Waits for stack answer
+	{
+		xErr = UDP_WRITEV;
+		FrontEndUnlock(req);
+		return -1;
+	}
+	ressent = req->res;
+	FrontEndUnlock(req);
+	return ressent;
+}
 
-/********************************************
- * Multicast section
- * *****************************************/
+/// @cond debug
+//	Only internal use: MAC address for broadcast and multicast IP addresses
+static void _UDPGroupMAC(NODE_INFO* node)
+{
+	BYTE i;
+	if ((node->IPAddr.Val == 0xFFFFFFFFul) || 
+		((node->IPAddr.Val | AppConfig.MyMask.Val) == 0xFFFFFFFFul))
+	{
+		for (i = 0; i < 6; i++)
+			node->MACAddr.v[i] = 0xFF;
+	}
+	else if ((node->IPAddr.v[0] & 0xF0) == 0xE0)
+	{
+		node->MACAddr.v[0] = 0x01;
+		node->MACAddr.v[1] = 0x00;
+		node->MACAddr.v[2] = 0x5E;
+		node->MACAddr.v[3] = node->IPAddr.v[1] & 0x7F;
+		node->MACAddr.v[4] = node->IPAddr.v[2];
+		node->MACAddr.v[5] = node->IPAddr.v[3];
+	}
+}
 
-void UDPMultiOn(char *multiaddress)
+int cUDPWriteV(FRONTEND_REQ* req)
 {
-	BOOL opok = FALSE;
-	//	Function cycles until it is not executed
-	while (!opok)
+	UDP_DGRAM* dg = (UDP_DGRAM*) req->data;
+	UDP_SOCKET sock = udpSocket[req->sock-1];
+	NODE_INFO sockNode = UDPSocketInfo[sock].remote.remoteNode;
+	UDP_PORT sockPort = UDPSocketInfo[sock].remotePort;
+	int i;
+	
+	req->res = 0;
+	for (i = 0; i < req->len; i++)
 	{
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
-		xErr = 0;
-		//	Check on xFrontEndStat, if TCP stck is currently in use, is different from 0
-		if (xFrontEndStat == 0)
+		dg[i].res = 0;
+		if (dg[i].remnode != NULL)
 		{
-			xFrontEndStatRet = 2;
-			ToSend = 38;
-
-			strncpy((char*)xIPAddress, multiaddress, strlen(multiaddress));
-
-			xQueueSendToBack(xQueue,&ToSend,0);					//	Send COMMAND request to the stack
-			xFrontEndStat = 1;
-			xSemaphoreGive(xSemFrontEnd);						//	xSemFrontEnd GIVE, the stack can answer to the command
-			opok = TRUE;
+			_UDPGroupMAC(dg[i].remnode);
+			UDPSocketInfo[sock].remote.remoteNode = *dg[i].remnode;
+			UDPSocketInfo[sock].remotePort = dg[i].remport;
 		}
 		else
 		{
-			xSemaphoreGive(xSemFrontEnd);
-			taskYIELD();
-			//	If WiFi module if turned OFF, function doesn't do anything
-			if (xFrontEndStat == -1)
-				return;
+			UDPSocketInfo[sock].remote.remoteNode = sockNode;
+			UDPSocketInfo[sock].remotePort = sockPort;
 		}
+		if (UDPIsPutReady(sock) < dg[i].len)
+			continue;
+		dg[i].res = UDPPutArray(dg[i].data, dg[i].len);
+		UDPFlush();
+		req->res++;
 	}
+	//	The socket keeps its receiver
+	UDPSocketInfo[sock].remote.remoteNode = sockNode;
+	UDPSocketInfo[sock].remotePort = sockPort;
+	return 0;
+}
+/// @endcond
 
-	while (xFrontEndStat != 2);					//	Waits for stack answer
-	while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);		//	xSemFrontEnd TAKE
 
-	xFrontEndStat = 0;
-	xSemaphoreGive(xSemFrontEnd);                                   //	xSemFrontEnd GIVE
-	taskYIELD();
+/********************************************
+ * Multicast section
+ * *****************************************/
 
+void UDPMultiOn(char *multiaddress)
+{
+	FRONTEND_REQ* req = FrontEndLock();
+	//	If WiFi module if turned OFF, function doesn't do anything
+	if (req == NULL)
+		return;
+	req->str = multiaddress;
+	FrontEndCall(req, 38);										//	Waits for stack answer
+	FrontEndUnlock(req);
 }
 
 typedef struct
@@ -522,12 +784,12 @@ typedef struct
 } IGMP_PACKET;
 
 
-int cUDPMultiOn()
+int cUDPMultiOn(FRONTEND_REQ* req)
 {
     IP_ADDR m_IP;
     IGMP_PACKET IGMPPacket;
 
-    StringToIPAddress((BYTE*)xIPAddress, &m_IP);
+    StringToIPAddress((BYTE*)req->str, &m_IP);
 
 #if defined (FLYPORT_WF)
     UINT8 multiMAC[6];
@@ -540,7 +802,7 @@ int cUDPMultiOn()
     multiMAC.v[0] = 0x01;
     multiMAC.v[1] = 0x00;
     multiMAC.v[2] = 0x5E;
-    multiMAC.v[3] = (UINT8)m_IP.v[1];
+    multiMAC.v[3] = (UINT8)m_IP.v[1] & 0x7F;	// only the low 23 bits of the group are mapped
     multiMAC.v[4] = (UINT8)m_IP.v[2];
     multiMAC.v[5] = (UINT8)m_IP.v[3];
     SetRXHashTableEntry(multiMAC);
@@ -560,7 +822,7 @@ int cUDPMultiOn()
         IGMPNode.MACAddr.v[0] = 0x01;
         IGMPNode.MACAddr.v[1] = 0x00;
         IGMPNode.MACAddr.v[2] = 0x5e;
-        IGMPNode.MACAddr.v[3] = m_IP.v[1];
+        IGMPNode.MACAddr.v[3] = m_IP.v[1] & 0x7F;
         IGMPNode.MACAddr.v[4] = m_IP.v[2];
         IGMPNode.MACAddr.v[5] = m_IP.v[3];
 
@@ -606,7 +868,7 @@ BYTE UDPMultiOpen (char *udpmultiaddr, char udpmultiport[])
         MulticastNode.MACAddr.v[0] = 0x01;
         MulticastNode.MACAddr.v[1] = 0x00;
         MulticastNode.MACAddr.v[2] = 0x5E;
-        MulticastNode.MACAddr.v[3] = MulticastNode.IPAddr.v[1];
+        MulticastNode.MACAddr.v[3] = MulticastNode.IPAddr.v[1] & 0x7F;
         MulticastNode.MACAddr.v[4] = MulticastNode.IPAddr.v[2];
         MulticastNode.MACAddr.v[5] = MulticastNode.IPAddr.v[3];
 		argNode = (DWORD) (unsigned int)&MulticastNode;
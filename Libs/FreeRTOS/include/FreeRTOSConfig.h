@@ -40,6 +40,7 @@
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetSchedulerState	1
 #define configUSE_MUTEXES 				1
 #define configKERNEL_INTERRUPT_PRIORITY	0x01
 
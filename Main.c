@@ -56,37 +56,21 @@ int _WFStat = NOT_CONNECTED;
 int WFStatusold;
 int WFConnection = WF_DEFAULT;
 
-static int Cmd = 0;
-
 
 //	FrontEnd variables
 BYTE xIPAddress[100];
-WORD xTCPPort = 22;
-TCP_SOCKET xSocket = INVALID_SOCKET;
 int xFrontEndStat = 0;
-int xFrontEndStatRet = 0;
 int xErr = 0;
-BOOL xBool = FALSE;
-WORD xWord;
-char *xChar;
-BYTE *xByte;
-BYTE xByte2;
-BYTE xByte3;
-int xInt;
-int xInt2;
-NODE_INFO xNode;
 
 BOOL WPAWrong = FALSE;
 extern SMTP_POINTERS SMTPClient;
 #if defined (FLYPORT_WF)
 extern RSSI_VAL myRSSI;
-	tWFNetwork xNet;
 #endif
 
 #if MAX_UDP_SOCKETS_FREERTOS>0
 //UDP variables:
 UDP_SOCKET udpSocket[MAX_UDP_SOCKETS_FREERTOS];
-WORD udpRxLen[MAX_UDP_SOCKETS_FREERTOS];
 WORD udpRxLenGlobal[MAX_UDP_SOCKETS_FREERTOS];
 BYTE numUdpSocket = 0;
 WORD BUFFER_UDP_LEN[MAX_UDP_SOCKETS_FREERTOS];
@@ -108,21 +92,10 @@ BYTE udpBuffer4[BUFFER4_UDP_LEN];
 
 UDP_PORT xUDPPort[MAX_UDP_SOCKETS_FREERTOS];
 
-BYTE* p_udp_wifiram[MAX_UDP_SOCKETS_FREERTOS];		//internal use
-BYTE* p_udp_data[MAX_UDP_SOCKETS_FREERTOS];			//user data
-WORD tmp_len[MAX_UDP_SOCKETS_FREERTOS];
-DWORD xUDPRemoteHost;
-WORD xUDPLocalPort = 0;
-WORD xUDPRemotePort = 0;
 BYTE activeUdpSocket = 0;
-BYTE callbackUdpSocket = 0;
 int udpErr = 0;
 BOOL udpBool = FALSE;
-WORD udpWord;
-int udpInt;
-BYTE *udpByte;
 
-int datadiscard = 0;
 BOOL UDPoverflow = 0;
 BOOL UDPoverflowFlag[MAX_UDP_SOCKETS_FREERTOS];
 #endif
@@ -132,91 +105,369 @@ xTaskHandle hTCPIPTask;
 xTaskHandle hFlyTask;
 xTaskHandle hTimerTask;
 xQueueHandle xQueue;
-xSemaphoreHandle xSemFrontEnd = NULL;
+xQueueHandle xFrontEndFree;					//	Request descriptors not in use
 xSemaphoreHandle xSemHW = NULL;
+xSemaphoreHandle xSemStack = NULL;			//	Held by the TCP/IP task while it runs the stack
 portBASE_TYPE xStatus;
 
-static int (*FP[40])();
+static int (*FP[FRONTEND_CMDS])(FRONTEND_REQ*);
+
+//	Request descriptors, see FrontEnd.h
+#define REQ_IDLE	0		//	Owned by a task, not sent yet
+#define REQ_QUEUED	1		//	Waiting in xQueue for the TCP/IP task
+#define REQ_RUNNING	2		//	Callback running inside the TCP/IP task
+#define REQ_DONE	3		//	Callback executed, results ready
+#define REQ_ABORTED	4		//	TCP/IP task deleted before the callback could run
+static FRONTEND_REQ FrontEndReq[FRONTEND_SLOTS];
+
+//	Max time spent serving queued requests in a single loop iteration
+#define FRONTEND_BUDGET		(5 / portTICK_RATE_MS)
+
+//	Max time the TCP/IP task sleeps between two loop iterations when no 
+//	request arrives, the stack must still be run regularly for its timers 
+//	and for the packets signalled by the MAC interrupt
+#define FRONTEND_IDLE		(5 / portTICK_RATE_MS)
+
+#if defined (FRONTEND_STATS)
+//	Latency histograms for each FP[] index, see FrontEndStats
+static WORD FrontEndHist[FRONTEND_CMDS][3][FRONTEND_BUCKETS];
+
+static void _FrontEndStat(int cmd, int kind, portTickType t)
+{
+	int b = 0;
+	while ((t > 0) && (b < FRONTEND_BUCKETS - 1))
+	{
+		t >>= 1;
+		b++;
+	}
+	taskENTER_CRITICAL();
+	if (FrontEndHist[cmd][kind][b] != 0xFFFF)
+		FrontEndHist[cmd][kind][b]++;
+	taskEXIT_CRITICAL();
+}
+#define FRONTEND_STAT(cmd, kind, t)	_FrontEndStat(cmd, kind, t)
+#else
+#define FRONTEND_STAT(cmd, kind, t)
+#endif
 
 
 void CmdCheck()
 {
+	FRONTEND_REQ* req;
+	portTickType start;
+
 	#if MAX_UDP_SOCKETS_FREERTOS>0 //UDP Stack
-	activeUdpSocket=0;
-	while (activeUdpSocket < MAX_UDP_SOCKETS_FREERTOS) 
+	//	Moves the received datagrams into the RX buffers
+	UDPRxFill();
+	#endif //UDP STACK
+
+	//	Serves all the queued requests before going back to the packet 
+	//	processing, unless they take more than FRONTEND_BUDGET
+	start = xTaskGetTickCount();
+	while (xQueueReceive(xQueue, &req, 0) == pdTRUE)
 	{
-		//Ring Buffer
-		if(udpSocket[activeUdpSocket] != INVALID_UDP_SOCKET)
+		BOOL run = FALSE;
+		//	The caller may have cancelled the request on timeout
+		taskENTER_CRITICAL();
+		if (req->stat == REQ_QUEUED)
 		{
-			//reads udp data and adds in ring buffer
-			udpRxLen[activeUdpSocket] = UDPIsGetReady(udpSocket[activeUdpSocket]);
+			req->stat = REQ_RUNNING;
+			run = TRUE;
+		}
+		taskEXIT_CRITICAL();
+		if (run)
+		{
+			#if defined (FRONTEND_STATS)
+			req->trun = xTaskGetTickCount();
+			FRONTEND_STAT(req->cmd, FE_HIST_WAIT, req->trun - req->tqueued);
+			#endif
+			//	Under the stack lock, so WFHibernate can't delete the task 
+			//	in the middle of a callback
+			StackLock();
+			FP[req->cmd](req);
+			StackUnlock();
+			FRONTEND_STAT(req->cmd, FE_HIST_EXEC, xTaskGetTickCount() - req->trun);
+			req->stat = REQ_DONE;
+			xSemaphoreGive(req->done);	//	Wakes up the caller
+			//	Lets the caller run, so its next request is queued and 
+			//	served within this same pass
+			taskYIELD();
+		}
+		if ((xTaskGetTickCount() - start) >= FRONTEND_BUDGET)
+			break;
+	}
+}
 
-			if(udpRxLen[activeUdpSocket] > (BUFFER_UDP_LEN[activeUdpSocket] - udpRxLenGlobal[activeUdpSocket]))
-			{
-				// Since there is not enough space to store the packet,
-				// discard all the transceiver RAM content related to UDP
-				datadiscard = udpRxLen[activeUdpSocket];
-				
-				// Set the Overflow Flags
-				UDPoverflow = 1;
-				UDPoverflowFlag[activeUdpSocket] = 1;
-				
-				// Now discard all remaining data in Udp Rx:
-				// Create a dummy array
-				BYTE removeArray[BUFFER_UDP_FIXED_LEN];
-				// update the datadiscard value
-				while(datadiscard > 0)
-				{
-					datadiscard -= UDPGetArray(removeArray, BUFFER_UDP_FIXED_LEN);
-				}
-			}
-			
-			if (udpRxLen[activeUdpSocket] > 0)
-			{
-				if( (p_udp_wifiram[activeUdpSocket]+udpRxLen[activeUdpSocket]) <= (udpBuffer[activeUdpSocket]+BUFFER_UDP_LEN[activeUdpSocket]) ) //append to buffer
-				{
-					UDPGetArray(p_udp_wifiram[activeUdpSocket], udpRxLen[activeUdpSocket]); //data
-					p_udp_wifiram[activeUdpSocket] += udpRxLen[activeUdpSocket];
-				}
-				else //append to buffer near end, or add to buffer from start
-				{
-					tmp_len[activeUdpSocket] = ((udpBuffer[activeUdpSocket]+BUFFER_UDP_LEN[activeUdpSocket]) - p_udp_wifiram[activeUdpSocket]);  //free space on ring buffer
-					if(tmp_len[activeUdpSocket] > 0) //fill buffer and add data from start
-					{
-						UDPGetArray(p_udp_wifiram[activeUdpSocket], tmp_len[activeUdpSocket]);
-						p_udp_wifiram[activeUdpSocket] = udpBuffer[activeUdpSocket];
-						UDPGetArray(p_udp_wifiram[activeUdpSocket], udpRxLen[activeUdpSocket] - tmp_len[activeUdpSocket] );
-						p_udp_wifiram[activeUdpSocket] += (udpRxLen[activeUdpSocket] - tmp_len[activeUdpSocket]);
-					}
-					else //add data to buffer from start
-					{ 
-						p_udp_wifiram[activeUdpSocket] = udpBuffer[activeUdpSocket];
-						UDPGetArray(p_udp_wifiram[activeUdpSocket], udpRxLen[activeUdpSocket]);
-						p_udp_wifiram[activeUdpSocket] += udpRxLen[activeUdpSocket];
-					}
-				}
-				udpRxLenGlobal[activeUdpSocket] += udpRxLen[activeUdpSocket];	
-			
-			} //end ring buffer
+/*****************************************************************************
+ FUNCTION 	CmdWait
+			Called by the TCP/IP task at the end of each loop iteration: 
+			sleeps until another task queues a request or FRONTEND_IDLE 
+			elapses, so the task doesn't keep the CPU busy when idle
+*****************************************************************************/
+void CmdWait()
+{
+	FRONTEND_REQ* req;
+	//	The request is left in the queue for CmdCheck
+	xQueuePeek(xQueue, &req, FRONTEND_IDLE);
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndInit
+			Creates the request queue and the free request descriptors
+ 
+ RETURNS  	FALSE if the RTOS objects can't be allocated
+*****************************************************************************/
+BOOL FrontEndInit()
+{
+	int i;
+	FRONTEND_REQ* req;
+
+	xQueue = xQueueCreate(FRONTEND_SLOTS, sizeof (FRONTEND_REQ*));
+	xFrontEndFree = xQueueCreate(FRONTEND_SLOTS, sizeof (FRONTEND_REQ*));
+	if ((xQueue == NULL) || (xFrontEndFree == NULL))
+		return FALSE;
+	for (i = 0; i < FRONTEND_SLOTS; i++)
+	{
+		req = &FrontEndReq[i];
+		req->stat = REQ_IDLE;
+		vSemaphoreCreateBinary(req->done);
+		if (req->done == NULL)
+			return FALSE;
+		xSemaphoreTake(req->done, 0);
+		xQueueSendToBack(xFrontEndFree, &req, 0);
+	}
+	return TRUE;
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndLock
+			Waits for a free request descriptor
+ 
+ RETURNS  	the descriptor, NULL if the WiFi module is turned off
+*****************************************************************************/
+FRONTEND_REQ* FrontEndLock()
+{
+	FRONTEND_REQ* req;
+
+	if (xFrontEndStat == -1)
+		return NULL;
+	xQueueReceive(xFrontEndFree, &req, portMAX_DELAY);
+	//	The WiFi may have been turned off while waiting
+	if (xFrontEndStat == -1)
+	{
+		xQueueSendToBack(xFrontEndFree, &req, 0);
+		return NULL;
+	}
+	xErr = 0;
+	req->stat = REQ_IDLE;
+	req->out = NULL;
+	return req;
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndCall
+			Runs the callback FP[cmd] inside the TCP/IP task and sleeps until 
+			it's done. The callback reads its parameters from the request 
+			and writes the results back into it.
+ 
+ RETURNS  	0 when the callback has been executed, -1 if the WiFi module is 
+			turned off, the request was not picked up within FRONTEND_TIMEOUT 
+			or it was aborted by FrontEndAbort
+ 
+ PARAMS		req - descriptor from FrontEndLock
+			cmd - index of the callback in FP[]
+*****************************************************************************/
+int FrontEndCall(FRONTEND_REQ* req, int cmd)
+{
+	BOOL cancelled = FALSE;
+
+	if (xFrontEndStat == -1)
+		return -1;
+	req->cmd = cmd;
+	#if defined (FRONTEND_STATS)
+	req->tqueued = xTaskGetTickCount();
+	#endif
+	req->stat = REQ_QUEUED;
+
+	if (xQueueSendToBack(xQueue, &req, FRONTEND_TIMEOUT) == pdTRUE)
+	{
+		if (xSemaphoreTake(req->done, FRONTEND_TIMEOUT) == pdTRUE)
+		{
+			if (req->stat == REQ_ABORTED)
+				return -1;
+			FRONTEND_STAT(cmd, FE_HIST_CALL, xTaskGetTickCount() - req->tqueued);
+			return 0;
 		}
-		activeUdpSocket++;
 	}
-	#endif //UDP STACK
 
-	if (Cmd != 0)
+	//	Not picked up in time: cancel the request. A stale pointer left in 
+	//	xQueue is skipped by CmdCheck, since the request is no more queued
+	taskENTER_CRITICAL();
+	if (req->stat == REQ_QUEUED)
+	{
+		req->stat = REQ_IDLE;
+		cancelled = TRUE;
+	}
+	taskEXIT_CRITICAL();
+	if (cancelled)
+		return -1;
+
+	//	Already started, the callback can't be stopped
+	xSemaphoreTake(req->done, portMAX_DELAY);
+	if (req->stat == REQ_ABORTED)
+		return -1;
+	FRONTEND_STAT(cmd, FE_HIST_CALL, xTaskGetTickCount() - req->tqueued);
+	return 0;
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndAbort
+			Called after the TCP/IP task has been deleted: the requests still 
+			queued, or picked up but not run yet, will never complete. Their 
+			callers are woken up and FrontEndCall returns -1.
+*****************************************************************************/
+void FrontEndAbort()
+{
+	int i;
+	FRONTEND_REQ* req;
+
+	while (xQueueReceive(xQueue, &req, 0) == pdTRUE);
+	for (i = 0; i < FRONTEND_SLOTS; i++)
 	{
-		int fresult = 0;
-		while (xSemaphoreTake(xSemFrontEnd,0) != pdTRUE);
-		if (xFrontEndStat == 1)
+		req = &FrontEndReq[i];
+		taskENTER_CRITICAL();
+		if ((req->stat == REQ_QUEUED) || (req->stat == REQ_RUNNING))
 		{
-			fresult = FP[Cmd]();
-			xFrontEndStat = xFrontEndStatRet;
-			xSemaphoreGive(xSemFrontEnd);
-			Cmd = 0;
-			taskYIELD();
+			req->stat = REQ_ABORTED;
+			xSemaphoreGive(req->done);
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndUnlock
+			Gives the request descriptor back, the next task waiting in 
+			FrontEndLock can use it
+*****************************************************************************/
+void FrontEndUnlock(FRONTEND_REQ* req)
+{
+	req->stat = REQ_IDLE;
+	xQueueSendToBack(xFrontEndFree, &req, 0);
+}
+
+/*****************************************************************************
+ FUNCTION 	StackLock
+			Waits until the TCP/IP task is out of the stack and keeps it out 
+			until StackUnlock. Unlike vTaskSuspendAll, the other tasks keep 
+			running: only the ones that need the stack still, such as 
+			WFHibernate before deleting the TCP/IP task, wait for it.
+*****************************************************************************/
+static portTickType StackLockStart = 0;
+static portTickType StackLockMax = 0;
+
+void StackLock()
+{
+	xSemaphoreTake(xSemStack, portMAX_DELAY);
+	StackLockStart = xTaskGetTickCount();
+}
+
+/*****************************************************************************
+ FUNCTION 	StackUnlock
+			Releases the stack, taken with StackLock
+*****************************************************************************/
+void StackUnlock()
+{
+	portTickType held = xTaskGetTickCount() - StackLockStart;
+	if (held > StackLockMax)
+		StackLockMax = held;
+	xSemaphoreGive(xSemStack);
+}
+
+/*****************************************************************************
+ FUNCTION 	StackLockMaxHold
+			Longest time the stack has been held with StackLock, that is 
+			the longest pass of StackTask, HTTPServer or a callback
+ 
+ RETURNS  	time in RTOS ticks
+ 
+ PARAMS		reset - TRUE to restart the measure
+*****************************************************************************/
+portTickType StackLockMaxHold(BOOL reset)
+{
+	portTickType max = StackLockMax;
+	if (reset)
+		StackLockMax = 0;
+	return max;
+}
+
+#if defined (FRONTEND_STATS)
+/*****************************************************************************
+ FUNCTION 	FrontEndStats
+			Histogram of the latencies of a callback, bucket 0 counts the 
+			requests that took 0 ticks, bucket n the ones that took from 
+			2^(n-1) to 2^n-1 ticks, the last one all the longer ones. 
+			Counters stop at 0xFFFF.
+ 
+ RETURNS  	array of FRONTEND_BUCKETS counters, NULL for a wrong index
+ 
+ PARAMS		cmd - index of the callback in FP[]
+			kind - FE_HIST_WAIT, FE_HIST_EXEC or FE_HIST_CALL
+*****************************************************************************/
+WORD* FrontEndStats(int cmd, int kind)
+{
+	if ((cmd < 0) || (cmd >= FRONTEND_CMDS) || (kind < FE_HIST_WAIT) || (kind > FE_HIST_CALL))
+		return NULL;
+	return FrontEndHist[cmd][kind];
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndStatsReset
+			Clears all the histograms
+*****************************************************************************/
+void FrontEndStatsReset()
+{
+	taskENTER_CRITICAL();
+	memset(FrontEndHist, 0, sizeof(FrontEndHist));
+	taskEXIT_CRITICAL();
+}
+
+/*****************************************************************************
+ FUNCTION 	FrontEndStatsDump
+			Writes the histograms of the callbacks used at least once on 
+			a UART, one line for each histogram: 
+			FP index, kind (W wait, E exec, C call), bucket counters
+ 
+ PARAMS		port - UART port
+*****************************************************************************/
+void FrontEndStatsDump(int port)
+{
+	static const char kinds[] = "WEC";
+	char line[12];
+	int cmd, kind, b;
+	WORD used;
+
+	for (cmd = 0; cmd < FRONTEND_CMDS; cmd++)
+	{
+		used = 0;
+		for (b = 0; b < FRONTEND_BUCKETS; b++)
+			used |= FrontEndHist[cmd][FE_HIST_CALL][b] | FrontEndHist[cmd][FE_HIST_EXEC][b];
+		if (used == 0)
+			continue;
+		for (kind = FE_HIST_WAIT; kind <= FE_HIST_CALL; kind++)
+		{
+			sprintf(line, "%d %c", cmd, kinds[kind]);
+			UARTWrite(port, line);
+			for (b = 0; b < FRONTEND_BUCKETS; b++)
+			{
+				sprintf(line, " %u", FrontEndHist[cmd][kind][b]);
+				UARTWrite(port, line);
+			}
+			UARTWrite(port, "\r\n");
 		}
 	}
 }
+#endif
 
 
 
@@ -233,6 +484,8 @@ void CmdCheck()
 ****************************************************************************/
 int main(void)
 {
+	BOOL frontend_ok;
+
 	// Initialize application specific hardware
 	HWInit(HWDEFAULT);	
 
@@ -244,13 +497,13 @@ int main(void)
 	#endif
 
 	//	Queue creation - will be used for communication between the stack and other tasks
-	xQueue = xQueueCreate(3, sizeof (int));
-
-	xSemFrontEnd = xSemaphoreCreateMutex();
+	frontend_ok = FrontEndInit();
+	xSemStack = xSemaphoreCreateMutex();
+	TCPRxWaitInit();
 	
 	
 	//	RTOS starting
-	if (xSemFrontEnd != NULL) 
+	if (frontend_ok && (xSemStack != NULL)) 
 	{
 		// Creates the task to handle all TCPIP functions
 		xTaskCreate(TCPIPTask, (signed char*) "TCP", STACK_SIZE_TCPIP,
@@ -318,6 +571,12 @@ void TCPIPTask()
 	FP[23] = cTCPGenericClose;
 	FP[24] = cTCPisConn;
 	FP[25] = cTCPRxLen;
+	FP[TCP_WRITEV] = cTCPWriteV;
+	FP[TCP_READMAX] = cTCPReadMax;
+	FP[TCP_BATCH] = cTCPBatch;
+	FP[TCP_FLUSH] = cTCPFlushNow;
+	FP[TCP_RING_ON] = cTCPRxRingOn;
+	FP[TCP_RING_OFF] = cTCPRxRingOff;
 
 
 	#if defined(STACK_USE_SMTP_CLIENT)
@@ -336,6 +595,7 @@ void TCPIPTask()
 	FP[36] = cUDPWrite;
 	FP[37] = cUDPGenericClose;
     FP[38] = cUDPMultiOn;
+	FP[UDP_WRITEV] = cUDPWriteV;
 	#endif
 	
 	// Initialize stack-related hardware components that may be 
@@ -406,7 +666,6 @@ void TCPIPTask()
 	activeUdpSocket=0;
 	while (activeUdpSocket < MAX_UDP_SOCKETS_FREERTOS) 
 	{
-		tmp_len[activeUdpSocket]=0;
 		if (activeUdpSocket == 0) 
 		{
 			BUFFER_UDP_LEN[0] = BUFFER1_UDP_LEN;
@@ -437,8 +696,7 @@ void TCPIPTask()
 			udpSocket[3] = INVALID_UDP_SOCKET;
 		}
 		#endif
-		p_udp_wifiram[activeUdpSocket] = udpBuffer[activeUdpSocket];
-		p_udp_data[activeUdpSocket] = udpBuffer[activeUdpSocket];
+		UDPRxReset(activeUdpSocket);
 		activeUdpSocket++;
 	}
 	#endif
@@ -474,13 +732,18 @@ void TCPIPTask()
 	        // This task performs normal stack task including checking
 	        // for incoming packet, type of packet and calling
 	        // appropriate stack entity to process it.
-			vTaskSuspendAll();
+			StackLock();
 			StackTask();
-			xTaskResumeAll();
+			StackUnlock();
+			// Fill the TCP RX rings, publish the socket states and wake up 
+			// the tasks waiting for data
+			TCPRxRingFill();
+			TCPSnapUpdate();
+			TCPRxWaitCheck();
 			#if defined(STACK_USE_HTTP_SERVER) || defined(STACK_USE_HTTP2_SERVER)
-			vTaskSuspendAll();
+			StackLock();
 			HTTPServer();
-			xTaskResumeAll();
+			StackUnlock();
 			#endif
 			// This tasks invokes each of the core stack application tasks
 	        StackApplications();
@@ -515,8 +778,7 @@ void TCPIPTask()
 			#endif
 
 
-			// Check on the queue to verify if other task have requested some stack function
-			xStatus = xQueueReceive(xQueue,&Cmd,0);
+			// Serve the stack functions requested by the other tasks
 			CmdCheck();
 			#if defined (FLYPORT_WF)
 			//	Check to verify the connection. If it's lost or failed, the device tries to reconnect
@@ -567,6 +829,9 @@ void TCPIPTask()
 				#endif
 			}
 		} //end check turnoff	
+		
+		// Sleep until a request arrives or the stack needs to run again
+		CmdWait();
 	}
 }
 
@@ -88,7 +88,7 @@
 //#define STACK_USE_DNS_SERVER			// Domain Name Service Server for redirection to the local device
 #define STACK_USE_NBNS					// NetBIOS Name Service Server for repsonding to NBNS hostname broadcast queries
 //#define STACK_USE_REBOOT_SERVER			// Module for resetting this PIC remotely.  Primarily useful for a Bootloader.
-//#define STACK_USE_SNTP_CLIENT			// Simple Network Time Protocol for obtaining current date/time from Internet
+#define STACK_USE_SNTP_CLIENT			// Simple Network Time Protocol for obtaining current date/time from Internet
 //#define STACK_USE_UDP_PERFORMANCE_TEST	// Module for testing UDP TX performance characteristics.  NOTE: Enabling this will cause a huge amount of UDP broadcast packets to flood your network on the discard port.  Use care when enabling this on production networks, especially with VPNs (could tunnel broadcast traffic across a limited bandwidth connection).
 //#define STACK_USE_TCP_PERFORMANCE_TEST	// Module for testing TCP TX performance characteristics
 //#define STACK_USE_DYNAMICDNS_CLIENT		// Dynamic DNS client updater module
@@ -259,42 +259,48 @@
 		#define TCP_PURPOSE_BERKELEY_CLIENT 11
 	#define END_OF_TCP_SOCKET_TYPES
 
+	// Define what types of sockets are needed, how many of
+	// each to include, where their TCB, TX FIFO, and RX FIFO
+	// should be stored, and how big the RX and TX FIFOs should
+	// be.  Making this initializer bigger or smaller defines
+	// how many total TCP sockets are available.
+	//
+	// Each socket requires up to 56 bytes of PIC RAM and
+	// 48+(TX FIFO size)+(RX FIFO size) bytes of TCP_*_RAM each.
+	//
+	// Note: The RX FIFO must be at least 1 byte in order to
+	// receive SYN and FIN messages required by TCP.  The TX
+	// FIFO can be zero if desired.
+	#define TCP_SOCKET_INITIALIZERS \
+{TCP_PURPOSE_GENERIC_TCP_CLIENT, TCP_ETH_RAM, 300, 200}, \
+{TCP_PURPOSE_GENERIC_TCP_SERVER, TCP_ETH_RAM, 200, 300}, \
+		/*{TCP_PURPOSE_TELNET, TCP_ETH_RAM, 200, 150},*/ \
+{TCP_PURPOSE_FTP_COMMAND, TCP_ETH_RAM, 60, 100}, \
+{TCP_PURPOSE_FTP_DATA, TCP_ETH_RAM, 100, 200}, \
+		/*{TCP_PURPOSE_TCP_PERFORMANCE_TX, TCP_ETH_RAM, 200, 1},*/ \
+		/*{TCP_PURPOSE_TCP_PERFORMANCE_RX, TCP_ETH_RAM, 40, 1500},*/ \
+		/*{TCP_PURPOSE_UART_2_TCP_BRIDGE, TCP_ETH_RAM, 256, 256},*/ \
+{TCP_PURPOSE_HTTP_SERVER, TCP_ETH_RAM, 1000, 1000}, \
+{TCP_PURPOSE_HTTP_SERVER, TCP_ETH_RAM, 1000, 1000}, \
+{TCP_PURPOSE_DEFAULT, TCP_ETH_RAM, 1000, 1000}, \
+		/*{TCP_PURPOSE_BERKELEY_SERVER, TCP_ETH_RAM, 25, 20},*/ \
+		/*{TCP_PURPOSE_BERKELEY_CLIENT, TCP_ETH_RAM, 125, 100}*/
+
+	typedef struct
+	{
+		BYTE vSocketPurpose;
+		BYTE vMemoryMedium;
+		WORD wTXBufferSize;
+		WORD wRXBufferSize;
+	} TCP_SOCKET_INIT;
+
+	// Number of TCP sockets, used by TCPlib.h: sizeof doesn't
+	// allocate the array
+	#define TCP_CONFIGURED_SOCKETS (sizeof((TCP_SOCKET_INIT[]){ TCP_SOCKET_INITIALIZERS }) / sizeof(TCP_SOCKET_INIT))
+
 	#if defined(__TCP_C)
-		// Define what types of sockets are needed, how many of
-		// each to include, where their TCB, TX FIFO, and RX FIFO
-		// should be stored, and how big the RX and TX FIFOs should
-		// be.  Making this initializer bigger or smaller defines
-		// how many total TCP sockets are available.
-		//
-		// Each socket requires up to 56 bytes of PIC RAM and
-		// 48+(TX FIFO size)+(RX FIFO size) bytes of TCP_*_RAM each.
-		//
-		// Note: The RX FIFO must be at least 1 byte in order to
-		// receive SYN and FIN messages required by TCP.  The TX
-		// FIFO can be zero if desired.
 		#define TCP_CONFIGURATION
-		ROM struct
-		{
-			BYTE vSocketPurpose;
-			BYTE vMemoryMedium;
-			WORD wTXBufferSize;
-			WORD wRXBufferSize;
-		} TCPSocketInitializer[] = 
-		{
-{TCP_PURPOSE_GENERIC_TCP_CLIENT, TCP_ETH_RAM, 300, 200},
-{TCP_PURPOSE_GENERIC_TCP_SERVER, TCP_ETH_RAM, 200, 300},
-			//{TCP_PURPOSE_TELNET, TCP_ETH_RAM, 200, 150},
-{TCP_PURPOSE_FTP_COMMAND, TCP_ETH_RAM, 60, 100},
-{TCP_PURPOSE_FTP_DATA, TCP_ETH_RAM, 100, 200},
-			//{TCP_PURPOSE_TCP_PERFORMANCE_TX, TCP_ETH_RAM, 200, 1},
-			//{TCP_PURPOSE_TCP_PERFORMANCE_RX, TCP_ETH_RAM, 40, 1500},
-			//{TCP_PURPOSE_UART_2_TCP_BRIDGE, TCP_ETH_RAM, 256, 256},
-{TCP_PURPOSE_HTTP_SERVER, TCP_ETH_RAM, 1000, 1000},
-{TCP_PURPOSE_HTTP_SERVER, TCP_ETH_RAM, 1000, 1000},
-{TCP_PURPOSE_DEFAULT, TCP_ETH_RAM, 1000, 1000},
-			//{TCP_PURPOSE_BERKELEY_SERVER, TCP_ETH_RAM, 25, 20},
-			//{TCP_PURPOSE_BERKELEY_CLIENT, TCP_ETH_RAM, 125, 100}
-		};
+		ROM TCP_SOCKET_INIT TCPSocketInitializer[] = { TCP_SOCKET_INITIALIZERS };
 		#define END_OF_TCP_CONFIGURATION
 	#endif
 
@@ -10,7 +10,10 @@
 #include "taskFlyport.h"
 #include "HTTPlib.h"
 #include "DYPTH01.h"
+#include "History.h"
+#include "Telemetry.h"
 #include "xiconfig.h"
+#include <time.h>
 
 /* PINS */
 #define PIN_SCK p8
@@ -21,24 +24,37 @@
 /* XIVELY PARAMETERS */
 #define XIVELY_SERVER "api.xively.com"
 #define XIVELY_PORT "80"
-#define XIVELY_BODY  "{\"version\":\"1.0.0\",\"datastreams\":" \
-    "[{\"id\":\"Temperature\",\"current_value\":\"%d.%d\"}," \
-    "{\"id\":\"Humidity\",\"current_value\":\"%d\"}]}"
+#define XIVELY_BODY_HEAD "{\"version\":\"1.0.0\",\"datastreams\":" \
+    "[{\"id\":\"Temperature\",\"datapoints\":["
+#define XIVELY_BODY_MID "]},{\"id\":\"Humidity\",\"datapoints\":["
+#define XIVELY_BODY_TAIL "]}]}"
+#define XIVELY_POINT "{\"at\":\"%s\",\"value\":\"%s\"}"
+#define XIVELY_POINT_MAX 48 // longest XIVELY_POINT plus separator
 
 /* XIVELY CALCULATED */
 #define XIVELY_HEADER "X-APIKey: " XIVELY_API_KEY "\r\nContent-Type: application/x-www-form-urlencoded\r\n"
 #define XIVELY_PATH "/v2/feeds/" XIVELY_FEED_ID
 
+/* BATCHING */
+#define BATCH_SIZE 5 // max readings sent with a single request
+#define BATCH_MAX_SENDS 4 // max requests in a row when catching up with the history
+#define BATCH_MAX_HOLD 300 // s, age of the oldest reading that forces an upload
+#define MIN_VALID_UTC 1388534400ul // 2014-01-01, the clock is not synchronized before
+
+/* MULTICAST TELEMETRY, uncomment to also publish each reading on the LAN */
+// #define TELEMETRY_MULTICAST
+#define TELEMETRY_GROUP "239.255.42.1"
+#define TELEMETRY_PORT "4210"
+
 /* DELAYS and TIMEOUTS */
-#define POLL_DELAY 20 // 200ms
 #define LOOP_DELAY 100 // 1s
 #define SOCKET_CONNECT_TIMEOUT 500 // 5s
 #define HTTP_TIMEOUT 700 // 7s
 #define SENSOR_POLL_INTERVAL 60 // 60s
+#define SENSOR_READ_TIMEOUT (430 / portTICK_RATE_MS) // RTOS ticks, not scaled like vTaskDelay
 
 static char _buf[250];
-static char _resp_Body[150];
-static char _resp_Header[150];
+static char _body[sizeof(XIVELY_BODY_HEAD XIVELY_BODY_MID XIVELY_BODY_TAIL) + 2 * BATCH_SIZE * XIVELY_POINT_MAX];
         
 static void _initWifi()
 {
@@ -50,41 +66,117 @@ static void _initWifi()
 	UARTWrite(1, "Thermus connected...hello world!\r\n");
 }
 
-/* timeout in 10ms units */
-/* 0 = connected, 1 = timeout */
-static int _waitConnection(TCP_SOCKET sock, int timeout)
+/* ISO 8601 UTC time, dst must hold 21 chars */
+static void _formatTime(char *dst, DWORD utc)
 {
-    int retries;
-   
-    for (retries = timeout / POLL_DELAY; !TCPisConn(sock) && retries > 0; --retries) {
-        UARTWrite(1, ".");
-        vTaskDelay(POLL_DELAY);
+    time_t tt = (time_t)utc;
+    struct tm *tm = gmtime(&tt);
+
+    sprintf(dst, "%04d-%02d-%02dT%02d:%02d:%02dZ", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
+        tm->tm_hour, tm->tm_min, tm->tm_sec);
+}
+
+/* appends the datapoints of the n oldest readings of one datastream to _body, returns the new end */
+static char *_appendPoints(char *dst, int n, int humidity)
+{
+    int i;
+    char at[21];
+    char value[8];
+    HIST_ITER it;
+    HIST_RECORD rec;
+    const HIST_RECORD *r = &rec;
+
+    HIST_First(&it);
+    for (i = 0; i < n && HIST_Next(&it, &rec); ++i) {
+        if (humidity) {
+            sprintf(value, "%d", r->hr);
+        } else {
+            int a = (r->t < 0) ? -r->t : r->t;
+            sprintf(value, "%s%d.%d", (r->t < 0) ? "-" : "", a / 10, a % 10);
+        }
+        _formatTime(at, r->at);
+        if (i > 0) {
+            *dst++ = ',';
+        }
+        dst += sprintf(dst, XIVELY_POINT, at, value);
     }
-    UARTWrite(1, "\r\n");
-    if (!TCPisConn(sock)) {
-        UARTWrite(1, "***Unable to connect to server\r\n");
-        return 1;
+    return dst;
+}
+
+/* true when the oldest readings in the history have to be sent */
+static BOOL _batchReady(DWORD now)
+{
+    HIST_ITER it;
+    HIST_RECORD oldest;
+
+    HIST_First(&it);
+    if (!HIST_Next(&it, &oldest)) {
+        return FALSE;
     }
-    UARTWrite(1, "Connected to server\r\n");
-    return 0;
+    return HIST_Count() >= BATCH_SIZE || now - oldest.at >= BATCH_MAX_HOLD;
+}
+
+/* sends the n oldest readings, reusing the connection to the server when still open */
+/* returns the HTTP code or READ_TIMEOUT */
+static int _putBatch(HTTP_CONN *conn, int n)
+{
+    int attempt;
+    int resp_code = READ_TIMEOUT;
+    char *p = _body;
+
+    p += sprintf(p, XIVELY_BODY_HEAD);
+    p = _appendPoints(p, n, 0);
+    p += sprintf(p, XIVELY_BODY_MID);
+    p = _appendPoints(p, n, 1);
+    sprintf(p, XIVELY_BODY_TAIL);
+
+    for (attempt = 0; attempt < 2; ++attempt) {
+        TCP_SOCKET sock = HTTP_ConnOpen(conn, SOCKET_CONNECT_TIMEOUT);
+        BOOL reused = conn->reused;
+        if (INVALID_SOCKET == sock) {
+            UARTWrite(1, "***Unable to connect to server\r\n");
+            return READ_TIMEOUT;
+        }
+        UARTWrite(1, reused ? "Reusing connection to server\r\n" : "Connected to server\r\n");
+        // only the status code is needed, the rest of the response is drained
+        resp_code = HTTP_PutStatus(sock, XIVELY_SERVER, XIVELY_PATH, XIVELY_HEADER, _body, HTTP_TIMEOUT);
+        if (READ_TIMEOUT != resp_code) {
+            break;
+        }
+        // the server may have closed an idle connection under our feet:
+        // drop it and retry once on a fresh one
+        HTTP_ConnClose(conn);
+        if (!reused) {
+            break;
+        }
+    }
+    return resp_code;
 }
 
 void FlyportTask()
 {
     DWORD next_read_tick = TickGetDiv64K();
+    HTTP_CONN xively;
+#ifdef TELEMETRY_MULTICAST
+    BOOL telem_open = FALSE;
+#endif
     
 	_initWifi();
     TH01_InitPort(PIN_SDI, PIN_SDO, PIN_SCK, PIN_SS_N);
+    HTTP_ConnInit(&xively, XIVELY_SERVER, XIVELY_PORT);
+    HIST_Init();
 
 	while (1)
 	{	
         DWORD cur_tick = TickGetDiv64K();
         
-        if (next_read_tick > cur_tick) {
+        if (cur_tick >= next_read_tick) {
             int t = -1;
             int hr = -1;
             int res = -1;
-            TCP_SOCKET XivelyClient = INVALID_SOCKET;
+            int sends;
+            DWORD now;
+            HIST_RECORD rec;
         
             next_read_tick = cur_tick + SENSOR_POLL_INTERVAL;
             sprintf(_buf, "Tick = %lu\r\n", cur_tick);
@@ -96,32 +188,48 @@ void FlyportTask()
                 sprintf(_buf, "***Stale TH01_ReadData() Error=%d\r\n", res);
                 UARTWrite(1, _buf);
             }
-            res = TH01_ReadData(&t, &hr);
-            if (res == 0) {
+            TH01_StartRead();
+            now = SNTPGetUTCSeconds();
+            
+            // while the sensor transfers the sample, upload the readings
+            // of the previous cycles: they stay in the history until the
+            // server accepts them, a backlog left by a failure is sent a
+            // batch at a time
+            for (sends = 0; sends < BATCH_MAX_SENDS && _batchReady(now); ++sends) {
+                int n = (HIST_Count() < BATCH_SIZE) ? HIST_Count() : BATCH_SIZE;
+                if (200 != _putBatch(&xively, n)) {
+                    UARTWrite(1, "HTTP request ERROR\r\n");
+                    break;
+                }
+                UARTWrite(1, "HTTP request OK\r\n");
+                HIST_Drop(n);
+            }
+            
+            res = TH01_WaitData(&t, &hr, SENSOR_READ_TIMEOUT);
+            if (res != 0) {
+                sprintf(_buf, "***Actual TH01_ReadData() Error=%d CRC errors=%u\r\n", res, TH01_GetCrcErrors());
+                UARTWrite(1, _buf);
+            } else if (now < MIN_VALID_UTC) {
+                UARTWrite(1, "***Clock not synchronized, reading dropped\r\n");
+            } else {
                 sprintf(_buf, "Temperature = %d.%d\r\n", t / 10, t % 10);
                 UARTWrite(1, _buf);
                 sprintf(_buf, "Humidity = %d%%\r\n", hr);
                 UARTWrite(1, _buf);
-            } else {
-                sprintf(_buf, "***Actual TH01_ReadData() Error=%d\r\n", res);
-                UARTWrite(1, _buf);
-            }
-            
-            XivelyClient = TCPClientOpen(XIVELY_SERVER, XIVELY_PORT);
-            if (0 == _waitConnection(XivelyClient, SOCKET_CONNECT_TIMEOUT)) {
-                int resp_code = 0;
-                sprintf(_buf, XIVELY_BODY, t / 10, t % 10, hr);
-                resp_code = HTTP_Put(XivelyClient, XIVELY_SERVER, XIVELY_PATH, XIVELY_HEADER, _buf,
-                    _resp_Header, sizeof(_resp_Header), _resp_Body, sizeof(_resp_Body), HTTP_TIMEOUT);
-                if(resp_code == 200) {
-					UARTWrite(1, "HTTP request OK\r\n");
-				} else {
-					UARTWrite(1, "HTTP request ERROR\r\n");
+                rec.at = now;
+                rec.t = t;
+                rec.hr = hr;
+                HIST_Add(&rec);
+#ifdef TELEMETRY_MULTICAST
+                if (!telem_open) {
+                    telem_open = TELEM_Open(TELEMETRY_GROUP, TELEMETRY_PORT);
+                }
+                if (!telem_open || !TELEM_Publish(&rec)) {
+                    UARTWrite(1, "***Telemetry datagram not sent\r\n");
                 }
+#endif
             }
-            TCPClientClose(XivelyClient);
-     
-            vTaskDelay(LOOP_DELAY);
         }
+        vTaskDelay(LOOP_DELAY);
     }
 }
@@ -16,23 +16,13 @@
 #define WFStatus WFGetStat()
 //	RTOS components - Semaphore and queues
 extern xQueueHandle xQueue;
-extern xSemaphoreHandle xSemFrontEnd;
 extern xSemaphoreHandle xSemHW;
 extern APP_CONFIG AppConfig;
 
 //	FrontEnd variables
 extern BYTE xIPAddress[];
-extern WORD xTCPPort;
-extern TCP_SOCKET xSocket;
 extern int xFrontEndStat;
 extern int xErr;
-extern BOOL xBool;
-extern WORD xWord;
-extern char *xChar;
-extern BYTE *xByte;
-extern BYTE xByte2;
-extern BYTE xByte3;
-extern NODE_INFO xNode;
 
 extern SMTP_POINTERS SMTPClient;
 extern BOOL DHCPAssigned;
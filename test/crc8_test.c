@@ -0,0 +1,100 @@
+/*
+ * crc8_test
+ * host check of CRC8_Calc: DYPTH01 frames, corrupted frames, agreement
+ * with the bitwise CRC it replaced, and a speed comparison of the two
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ *
+ * Build and run from the repository root, see test/README.md:
+ *   cc -O2 -I Libs/ExternalLib/Include -o crc8_test test/crc8_test.c Libs/ExternalLib/Crc8.c && ./crc8_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Crc8.h"
+
+#define BENCH_LEN 4 // a DYPTH01 frame
+#define BENCH_ROUNDS 5000000L
+
+/* the bitwise version used before the table */
+static unsigned char _crc8_bitwise(const unsigned char *x, int len)
+{
+    int i, b;
+    unsigned char crc = 0;
+
+    for (i = 0; i < len; ++i) {
+        crc ^= x[i];
+        for (b = 0; b < 8; ++b) {
+            crc = (crc & 0x80) ? (unsigned char)((crc << 1) ^ 0x31) : (unsigned char)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static int _failures = 0;
+
+static void _check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        ++_failures;
+    }
+}
+
+static double _bench(unsigned char (*crc)(const unsigned char *, int), const unsigned char *buf, unsigned *sink)
+{
+    long r;
+    clock_t start = clock();
+    for (r = 0; r < BENCH_ROUNDS; ++r) {
+        *sink += crc(buf, BENCH_LEN);
+        *sink ^= (unsigned)r; // keeps the calls inside the loop
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+    /* frames: humidity, temperature high, temperature low, CRC */
+    static const unsigned char good[][4] = {
+        { 0x02, 0xB3, 0x51, 0x7F }, // datasheet example
+        { 0x00, 0x00, 0x00, 0x00 },
+    };
+    unsigned char frame[4];
+    unsigned char buf[64];
+    unsigned sink = 0;
+    double t_table, t_bitwise;
+    int i, bit, len;
+
+    for (i = 0; i < (int)(sizeof(good) / sizeof(good[0])); ++i) {
+        _check(CRC8_Calc(good[i], 4) == 0, "valid frame rejected");
+        _check(CRC8_Calc(good[i], 3) == good[i][3], "CRC of the payload differs from the frame CRC");
+    }
+
+    /* every single bit error is detected */
+    for (bit = 0; bit < 32; ++bit) {
+        for (i = 0; i < 4; ++i) {
+            frame[i] = good[0][i];
+        }
+        frame[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+        _check(CRC8_Calc(frame, 4) != 0, "corrupted frame accepted");
+    }
+
+    /* same result as the bitwise version on any data */
+    srand(1);
+    for (i = 0; i < 10000; ++i) {
+        len = rand() % (int)sizeof(buf);
+        for (bit = 0; bit < len; ++bit) {
+            buf[bit] = (unsigned char)rand();
+        }
+        _check(CRC8_Calc(buf, len) == _crc8_bitwise(buf, len), "table and bitwise CRC differ");
+    }
+
+    t_table = _bench(CRC8_Calc, good[0], &sink);
+    t_bitwise = _bench(_crc8_bitwise, good[0], &sink);
+    printf("%ld frames: table %.3fs, bitwise %.3fs (%.1fx) [%u]\n",
+        BENCH_ROUNDS, t_table, t_bitwise, t_table > 0 ? t_bitwise / t_table : 0.0, sink & 1);
+
+    printf(_failures ? "crc8_test: %d failures\n" : "crc8_test: OK\n", _failures);
+    return _failures ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * ring_read_bench
+ * host comparison of the RX ring copies of UARTRead (HWlib.c): the former
+ * byte loop with a wrap-around test on each byte, and the current copy in
+ * at most two memcpy, RingRead of RingCopy.h, the same code HWlib.c calls.
+ * Both copies are checked to give the same bytes and read index for every
+ * start position and length, then timed.
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ *
+ * Build and run from the repository root, see test/README.md:
+ *   cc -O2 -I "Libs/Flyport libs/Include" -o ring_read_bench test/ring_read_bench.c && ./ring_read_bench
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "RingCopy.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES 1
+#endif
+
+#define RING_SIZE 256 // UART_BUFFER_SIZE
+#define BENCH_BYTES 200000000L
+
+static char _ring[RING_SIZE];
+
+/* UARTRead before the change */
+static int _read_bytes(char *towrite, int bufind_r, int count)
+{
+    int irx = 0;
+    while (irx < count)
+    {
+        *(towrite+irx) = *(_ring+bufind_r);
+
+        if (bufind_r == RING_SIZE-1)
+            bufind_r = 0;
+        else
+            bufind_r++;
+
+        irx++;
+    }
+    return bufind_r;
+}
+
+/* UARTRead now, the RingRead it calls */
+static int _read_memcpy(char *towrite, int bufind_r, int count)
+{
+    return RingRead(towrite, _ring, RING_SIZE, bufind_r, count);
+}
+
+typedef int (*READ_FN)(char *, int, int);
+
+/* returns bytes per cycle, or bytes per ns without a cycle counter */
+static double _bench(READ_FN fn, int count, unsigned *sink)
+{
+    static char out[RING_SIZE];
+    long rounds = BENCH_BYTES / count;
+    long r;
+    int pos = 0;
+#ifdef HAVE_CYCLES
+    unsigned long long start = __rdtsc();
+#else
+    clock_t start = clock();
+#endif
+
+    for (r = 0; r < rounds; ++r) {
+        pos = fn(out, pos, count);
+        *sink += (unsigned char)out[count - 1]; // keeps the copy
+    }
+#ifdef HAVE_CYCLES
+    return (double)rounds * count / (double)(__rdtsc() - start);
+#else
+    return (double)rounds * count / ((double)(clock() - start) * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+int main(void)
+{
+    static const int sizes[] = { 1, 8, 32, 128, 255 };
+    char a[RING_SIZE], b[RING_SIZE];
+    unsigned sink = 0;
+    int failures = 0;
+    int i, start, count;
+
+    for (i = 0; i < RING_SIZE; ++i) {
+        _ring[i] = (char)(i * 7 + 3);
+    }
+
+    for (start = 0; start < RING_SIZE; ++start) {
+        for (count = 0; count < RING_SIZE; ++count) {
+            memset(a, 0, sizeof(a));
+            memset(b, 0, sizeof(b));
+            if (_read_bytes(a, start, count) != _read_memcpy(b, start, count) || memcmp(a, b, count) != 0) {
+                printf("FAIL: start %d count %d\n", start, count);
+                ++failures;
+            }
+        }
+    }
+
+    printf("%-6s %12s %12s\n", "bytes", "byte loop", "memcpy");
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); ++i) {
+        double before = _bench(_read_bytes, sizes[i], &sink);
+        double after = _bench(_read_memcpy, sizes[i], &sink);
+        printf("%-6d %12.3f %12.3f\n", sizes[i], before, after);
+    }
+#ifdef HAVE_CYCLES
+    printf("bytes per cycle [%u]\n", sink & 1);
+#else
+    printf("bytes per ns [%u]\n", sink & 1);
+#endif
+
+    printf(failures ? "ring_read_bench: %d failures\n" : "ring_read_bench: OK\n", failures);
+    return failures ? 1 : 0;
+}
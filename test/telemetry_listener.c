@@ -0,0 +1,166 @@
+/*
+ * telemetry_listener
+ * reference receiver of the datagrams sent by Telemetry.c: joins the
+ * multicast group, checks the CRC and prints each reading, reporting the
+ * readings lost between two sequence numbers
+ *
+ * Part of Thermus, released under the MIT license (http://opensource.org/licenses/MIT)
+ *
+ * Build from the repository root on a POSIX system, see test/README.md:
+ *   cc -O2 -I Libs/ExternalLib/Include -o telemetry_listener test/telemetry_listener.c Libs/ExternalLib/Crc8.c
+ *   ./telemetry_listener [group [port]]   listens, default 239.255.42.1 4210
+ *   ./telemetry_listener --check          decodes a built-in datagram and exits
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "Crc8.h"
+
+/* layout documented in Telemetry.h */
+#define TELEM_VERSION 1
+#define TELEM_PACKET_SIZE 17
+
+#define DEF_GROUP "239.255.42.1" // TELEMETRY_GROUP in taskFlyport.c
+#define DEF_PORT 4210 // TELEMETRY_PORT in taskFlyport.c
+
+typedef struct {
+    unsigned char mac[6];
+    unsigned int seq;
+    unsigned long at;
+    int t; /* 0.1C units */
+    int hr;
+} READING;
+
+/* returns 0 when the datagram is a valid reading */
+static int _decode(const unsigned char *p, int len, READING *r)
+{
+    if (len != TELEM_PACKET_SIZE) {
+        return 1;
+    }
+    if (p[0] != TELEM_VERSION) {
+        return 2;
+    }
+    if (CRC8_Calc(p, TELEM_PACKET_SIZE) != 0) {
+        return 3;
+    }
+    memcpy(r->mac, &p[1], 6);
+    r->seq = ((unsigned int)p[7] << 8) | p[8];
+    r->at = ((unsigned long)p[9] << 24) | ((unsigned long)p[10] << 16) | ((unsigned long)p[11] << 8) | p[12];
+    r->t = (short)(((unsigned int)p[13] << 8) | p[14]);
+    r->hr = p[15];
+    return 0;
+}
+
+static void _print(const READING *r)
+{
+    char when[32];
+    time_t at = (time_t)r->at;
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%SZ", gmtime(&at));
+    printf("%02X:%02X:%02X:%02X:%02X:%02X seq=%u %s T=%s%d.%dC HR=%d%%\n",
+        r->mac[0], r->mac[1], r->mac[2], r->mac[3], r->mac[4], r->mac[5],
+        r->seq, when, (r->t < 0) ? "-" : "", abs(r->t) / 10, abs(r->t) % 10, r->hr);
+}
+
+static int _check(void)
+{
+    /* 00:04:A3:12:34:56, seq 258, 2014-10-19T12:00:00Z, -2.5C, 55% */
+    unsigned char pkt[TELEM_PACKET_SIZE] = {
+        1, 0x00, 0x04, 0xA3, 0x12, 0x34, 0x56, 0x01, 0x02,
+        0x54, 0x43, 0xA7, 0xC0, 0xFF, 0xE7, 55, 0
+    };
+    READING r;
+    int failures = 0;
+
+    pkt[16] = CRC8_Calc(pkt, TELEM_PACKET_SIZE - 1);
+    if (_decode(pkt, sizeof(pkt), &r) != 0 || r.seq != 258 || r.at != 1413720000ul || r.t != -25 || r.hr != 55) {
+        printf("FAIL: valid datagram\n");
+        ++failures;
+    } else {
+        _print(&r);
+    }
+    pkt[13] ^= 0x10;
+    if (_decode(pkt, sizeof(pkt), &r) != 3) {
+        printf("FAIL: corrupted datagram accepted\n");
+        ++failures;
+    }
+    if (_decode(pkt, sizeof(pkt) - 1, &r) != 1) {
+        printf("FAIL: short datagram accepted\n");
+        ++failures;
+    }
+    printf(failures ? "telemetry_listener: %d failures\n" : "telemetry_listener: OK\n", failures);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *group = DEF_GROUP;
+    int port = DEF_PORT;
+    int sock, one = 1, have_seq = 0;
+    unsigned int next_seq = 0;
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        return _check();
+    }
+    if (argc > 1) {
+        group = argv[1];
+    }
+    if (argc > 2) {
+        port = atoi(argv[2]);
+    }
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    mreq.imr_multiaddr.s_addr = inet_addr(group);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror("IP_ADD_MEMBERSHIP");
+        return 1;
+    }
+    printf("listening on %s:%d\n", group, port);
+
+    while (1) {
+        unsigned char buf[64];
+        struct sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        READING r;
+        int res;
+        int len = (int)recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromlen);
+        if (len < 0) {
+            perror("recvfrom");
+            return 1;
+        }
+        res = _decode(buf, len, &r);
+        if (res != 0) {
+            printf("%s: bad datagram, %s\n", inet_ntoa(from.sin_addr),
+                (res == 1) ? "wrong length" : (res == 2) ? "unknown version" : "wrong CRC");
+            continue;
+        }
+        if (have_seq && r.seq != next_seq) {
+            printf("%u readings lost\n", (r.seq - next_seq) & 0xFFFF);
+        }
+        have_seq = 1;
+        next_seq = (r.seq + 1) & 0xFFFF;
+        _print(&r);
+        fflush(stdout);
+    }
+}